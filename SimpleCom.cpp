@@ -55,9 +55,12 @@
   
   The library uses Timer 0 (8 bit) in CTC mode for the
   communication, so one must be careful when manipulating
-  timers. If necessary, Timer definitions can be easily
-  changed to use with other timers (perhaps for the next
-  version, and we surely appreciate code suggestions).
+  timers. Timer 2 can be used instead (see SC_TIMER), so
+  Timer 0 is left to millis() and delay(). The receivers
+  can also use the input capture unit of Timer 1 (16 bit)
+  to timestamp the transitions (see SC_USE_ICP) and the
+  transmitters its output compare unit to toggle the pin
+  (see SC_USE_OC).
   
   NOTE: this library is currently valid only for wired
   transmissions (1 wire + GND), and a newer version is
@@ -69,6 +72,19 @@
 
 #include "SimpleCom.h"
 #include <math.h> //only for abs()
+#include <avr/pgmspace.h> //for the tables of the CRCs
+
+
+// Pin access (cached port register & bit mask of the instance)
+//  NOTE: the write is not atomic, so disable interrupts when calling
+//          from outside the timer interrupt
+#if SC_FAST_IO
+#define SC_PIN_WRITE(value) do{ if(value) *_port |= _mask; else *_port &= ~_mask; }while(0)
+#define SC_PIN_READ() ((*_port & _mask) ? HIGH : LOW)
+#else
+#define SC_PIN_WRITE(value) digitalWrite(_pin, (value))
+#define SC_PIN_READ() digitalRead(_pin)
+#endif
 
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -80,9 +96,32 @@
 uint8_t ReceiversNumber = 0; //DO NOT change outside this library
 SCreceiver *Receivers[SC_MAX_RECEIVERS];
 
+// listenning Receivers (handled by the timer interrupt)
+uint8_t ActiveReceiversNumber = 0; //DO NOT change outside this library
+SCreceiver *ActiveReceivers[SC_MAX_RECEIVERS];
+uint8_t ActiveReceiversTimeoutIndex = 0; // receiver to check for time overflow on the next tick
+
+// input registers of the Receivers (each register is read once per tick)
+uint8_t ReceiverPortsNumber = 0; //DO NOT change outside this library
+volatile uint8_t *ReceiverPorts[SC_MAX_RECEIVERS];
+uint8_t ReceiverPortsUsers[SC_MAX_RECEIVERS]; // number of receivers using the register
+uint8_t ReceiverPortsValue[SC_MAX_RECEIVERS]; // value read on the last tick
+uint8_t ReceiverPortsChanged[SC_MAX_RECEIVERS]; // bits changed on the last tick
+
 uint8_t TransmittersNumber = 0; //DO NOT change outside this library
 SCtransmitter *Transmitters[SC_MAX_TRANSMITTERS];
 
+// sending Transmitters (handled by the timer interrupt)
+uint8_t ActiveTransmittersNumber = 0; //DO NOT change outside this library
+SCtransmitter *ActiveTransmitters[SC_MAX_TRANSMITTERS];
+
+// output registers of the Transmitters (each register is written once per tick)
+uint8_t TransmitterPortsNumber = 0; //DO NOT change outside this library
+volatile uint8_t *TransmitterPorts[SC_MAX_TRANSMITTERS];
+uint8_t TransmitterPortsUsers[SC_MAX_TRANSMITTERS]; // number of transmitters using the register
+uint8_t TransmitterPortsSet[SC_MAX_TRANSMITTERS]; // bits to set on the next write
+uint8_t TransmitterPortsClear[SC_MAX_TRANSMITTERS]; // bits to clear on the next write
+
 void printlala(void){ //TESTE
       Serial.print("Rec: ");
       Serial.println(ReceiversNumber);
@@ -91,6 +130,50 @@ void printlala(void){ //TESTE
 }
 
 
+// Add a Receiver to the list of active receivers
+//  (returns the number of active receivers or 0 if not added)
+//  NOTE: does not start the timer
+uint8_t AddActiveReceiver(SCreceiver *receiver){
+  for(uint8_t i=0 ; i < ActiveReceiversNumber ; i++){
+    if(ActiveReceivers[i] == receiver)
+      return ActiveReceiversNumber; //already active
+  }
+  
+  if(ActiveReceiversNumber >= SC_MAX_RECEIVERS)
+    return 0;
+  
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt reads the list
+  ActiveReceivers[ActiveReceiversNumber++] = receiver;
+  SREG = oldSREG;
+  
+  return ActiveReceiversNumber;
+}
+
+// -------------------------------------------------------------------------
+
+// Add a Transmitter to the list of active transmitters
+//  (returns the number of active transmitters or 0 if not added)
+//  NOTE: does not start the timer
+uint8_t AddActiveTransmitter(SCtransmitter *transmitter){
+  for(uint8_t i=0 ; i < ActiveTransmittersNumber ; i++){
+    if(ActiveTransmitters[i] == transmitter)
+      return ActiveTransmittersNumber; //already active
+  }
+  
+  if(ActiveTransmittersNumber >= SC_MAX_TRANSMITTERS)
+    return 0;
+  
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt reads the list
+  ActiveTransmitters[ActiveTransmittersNumber++] = transmitter;
+  SREG = oldSREG;
+  
+  return ActiveTransmittersNumber;
+}
+
+// -------------------------------------------------------------------------
+
 // Add a Receiver to the list
 //  (returns the number of receivers or 0 if not added)
 uint8_t AddReceiver(SCreceiver *receiver){
@@ -117,6 +200,124 @@ uint8_t AddTransmitter(SCtransmitter *transmitter){
 
 // -------------------------------------------------------------------------
 
+// Add the input register of a Receiver to the list of ports
+//  (returns the index of the register or 0xFF if not added)
+//  NOTE: the indexes do not change when a register is removed
+uint8_t AddReceiverPort(volatile uint8_t *port){
+  uint8_t index = 0xFF;
+  for(uint8_t i=0 ; i < ReceiverPortsNumber ; i++){
+    if(ReceiverPorts[i] == port){
+      ReceiverPortsUsers[i]++; //already in the list
+      return i;
+    } else if((ReceiverPortsUsers[i] == 0) && (index == 0xFF)){
+      index = i; //first free index
+    }
+  }
+  
+  //add to the list
+  if(index == 0xFF){
+    if(ReceiverPortsNumber >= SC_MAX_RECEIVERS)
+      return 0xFF;
+    index = ReceiverPortsNumber;
+  }
+  
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt reads the list
+  ReceiverPorts[index] = port;
+  ReceiverPortsUsers[index] = 1;
+  ReceiverPortsValue[index] = *port;
+  ReceiverPortsChanged[index] = 0;
+  if(index == ReceiverPortsNumber)
+    ReceiverPortsNumber++; //update counter
+  SREG = oldSREG;
+  
+  return index;
+}
+
+// -------------------------------------------------------------------------
+
+// Add the output register of a Transmitter to the list of ports
+//  (returns the index of the register or 0xFF if not added)
+//  NOTE: the indexes do not change when a register is removed
+uint8_t AddTransmitterPort(volatile uint8_t *port){
+  uint8_t index = 0xFF;
+  for(uint8_t i=0 ; i < TransmitterPortsNumber ; i++){
+    if(TransmitterPorts[i] == port){
+      TransmitterPortsUsers[i]++; //already in the list
+      return i;
+    } else if((TransmitterPortsUsers[i] == 0) && (index == 0xFF)){
+      index = i; //first free index
+    }
+  }
+  
+  //add to the list
+  if(index == 0xFF){
+    if(TransmitterPortsNumber >= SC_MAX_TRANSMITTERS)
+      return 0xFF;
+    index = TransmitterPortsNumber;
+  }
+  
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt reads the list
+  TransmitterPorts[index] = port;
+  TransmitterPortsUsers[index] = 1;
+  TransmitterPortsSet[index] = 0;
+  TransmitterPortsClear[index] = 0;
+  if(index == TransmitterPortsNumber)
+    TransmitterPortsNumber++; //update counter
+  SREG = oldSREG;
+  
+  return index;
+}
+
+// -------------------------------------------------------------------------
+
+// Remove a Receiver from the list of active receivers
+//  (returns 0 if the receiver was not found, 1 otherwise)
+//  NOTE: can be called from the timer interrupt (the last receiver replaces the removed one)
+uint8_t RemoveActiveReceiver(SCreceiver *receiver){
+  uint8_t found = 0;
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt reads the list
+  for(uint8_t i=0 ; i < ActiveReceiversNumber ; i++){
+    if(ActiveReceivers[i] == receiver){
+      ActiveReceivers[i] = ActiveReceivers[ActiveReceiversNumber - 1]; //replace by last one
+      ActiveReceivers[ActiveReceiversNumber - 1] = NULL; //remove last one
+      ActiveReceiversNumber--; //update counter
+      found = 1; //found something
+      break;
+    }
+  }
+  SREG = oldSREG;
+  
+  return found;
+}
+
+// -------------------------------------------------------------------------
+
+// Remove a Transmitter from the list of active transmitters
+//  (returns 0 if the transmitter was not found, 1 otherwise)
+//  NOTE: can be called from the timer interrupt (the last transmitter replaces the removed one)
+uint8_t RemoveActiveTransmitter(SCtransmitter *transmitter){
+  uint8_t found = 0;
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt reads the list
+  for(uint8_t i=0 ; i < ActiveTransmittersNumber ; i++){
+    if(ActiveTransmitters[i] == transmitter){
+      ActiveTransmitters[i] = ActiveTransmitters[ActiveTransmittersNumber - 1]; //replace by last one
+      ActiveTransmitters[ActiveTransmittersNumber - 1] = NULL; //remove last one
+      ActiveTransmittersNumber--; //update counter
+      found = 1; //found something
+      break;
+    }
+  }
+  SREG = oldSREG;
+  
+  return found;
+}
+
+// -------------------------------------------------------------------------
+
 // Remove a Receiver from the list
 //  (returns 0 if the receiver was not found, 1 otherwise)
 uint8_t RemoveReceiver(SCreceiver *receiver){
@@ -167,13 +368,36 @@ uint8_t RemoveTransmitter(SCtransmitter *transmitter){
   return found;
 }
 
+// -------------------------------------------------------------------------
+
+// Remove a Receiver from the users of a register of the list of ports
+void RemoveReceiverPort(uint8_t index){
+  if(index >= ReceiverPortsNumber)
+    return;
+  
+  if(ReceiverPortsUsers[index] > 0)
+    ReceiverPortsUsers[index]--; //the index is free when there are no more users
+}
+
+// -------------------------------------------------------------------------
+
+// Remove a Transmitter from the users of a register of the list of ports
+void RemoveTransmitterPort(uint8_t index){
+  if(index >= TransmitterPortsNumber)
+    return;
+  
+  if(TransmitterPortsUsers[index] > 0)
+    TransmitterPortsUsers[index]--; //the index is free when there are no more users
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 
 // *************************************************************************
 // ******************************* TIMER ***********************************
 // *************************************************************************
 
-uint8_t SC_TIMER_STARTED = 0; // 1 if started (DO NOT change from outside this library)
+volatile uint8_t SC_TIMER_STARTED = 0; // 1 if started (DO NOT change from outside this library)
+volatile uint16_t SC_Ticks = 0; // number of ticks (DO NOT change from outside this library)
 
 // Configure Timer 0 to reset on compare for 10 us
 
@@ -186,24 +410,24 @@ uint8_t SC_TIMER_STARTED = 0; // 1 if started (DO NOT change from outside this l
 //  TCCR0B = 0x01; .............. Timer0 Control Reg B: Timer Prescaler set to 1 (and Timer ON)
 
 
-//configure Timer 0 (8 bits) to 10 us
+//configure the timer of the ticks (8 bits, Timer 0 or Timer 2, see SC_TIMER)
 //  (Arduino > 16 MHz and Prescaler de 1)
-#define TIMER0_CONFIGURE() ({ \
-  TIMSK0 = 0x00; \
-  TCCR0B = T_PRESCALER; \
-  TCCR0A = 0x02; \
-  TCNT0  = 0; \
-  OCR0A = T_OCR0A; \
-  TIFR0  = 0x00; \
-  TIMSK0 = 0x02; \
+#define TIMER_CONFIGURE() ({ \
+  T_TIMSK = 0x00; \
+  T_TCCRB = T_PRESCALER; \
+  T_TCCRA = 0x02; \
+  T_TCNT  = 0; \
+  T_OCRA = T_OCR; \
+  T_TIFR  = 0x00; \
+  T_TIMSK = 0x02; \
 })
 
-#define TIMER0_DISABLE (TIMSK0 = 0x00)
+#define TIMER_DISABLE (T_TIMSK = 0x00)
 
-#define TIMER0_ENABLE (TIMSK0 = 0x02)
+#define TIMER_ENABLE (T_TIMSK = 0x02)
 
-#define TIMER0_RESET ({ \
-  TIFR0  = 0x00; \
+#define TIMER_RESET ({ \
+  T_TIFR  = 0x00; \
 })
 
 // -------------------------------------------------------------------------
@@ -211,20 +435,172 @@ uint8_t SC_TIMER_STARTED = 0; // 1 if started (DO NOT change from outside this l
 // Timer Compare Interrupt
 //   Handles communication >> Transmitter also uses timer because receiver
 //                            interrupt can cause interference if using delay
-ISR(TIMER0_COMPA_vect){
+ISR(T_COMPA_vect){
   // do not disable & enable timer here, because frequency must remain constant
+  SC_Timer_Tick();
+}
+
+// -------------------------------------------------------------------------
+
+// Handle one tick of the timer
+//  NOTE: public only to measure the cost of a tick (see the Benchmark example)
+void SC_Timer_Tick(void){
+  SC_Ticks++; //update (free running)
   
-  // send signals
-  for(uint8_t i=0 ; i < TransmittersNumber ; i++){
-    Transmitters[i]->Transmit();
+  // send signals (backwards, because a transmitter is removed from the list when it stops)
+  for(uint8_t i=ActiveTransmittersNumber ; i > 0 ; i--){
+    ActiveTransmitters[i - 1]->Transmit();
+  }
+  
+#if SC_FAST_IO
+  // write the signals (once per port, so all the pins of the port change at the same time)
+  for(uint8_t i=0 ; i < TransmitterPortsNumber ; i++){
+    if(TransmitterPortsSet[i] | TransmitterPortsClear[i]){
+      *TransmitterPorts[i] = (*TransmitterPorts[i] | TransmitterPortsSet[i]) & ~TransmitterPortsClear[i];
+      TransmitterPortsSet[i] = 0; //reset
+      TransmitterPortsClear[i] = 0; //reset
+    }
+  }
+#endif
+  
+  if(ActiveReceiversNumber > 0){
+#if SC_FAST_IO
+    // sample the signals (once per port)
+    for(uint8_t i=0 ; i < ReceiverPortsNumber ; i++){
+      uint8_t value = *ReceiverPorts[i];
+      ReceiverPortsChanged[i] = value ^ ReceiverPortsValue[i];
+      ReceiverPortsValue[i] = value;
+    }
+    
+    // handle incoming signals (only the receivers with a transition)
+    for(uint8_t i=ActiveReceiversNumber ; i > 0 ; i--){
+      if(ReceiverPortsChanged[ActiveReceivers[i - 1]->_port_index] & ActiveReceivers[i - 1]->_mask)
+        ActiveReceivers[i - 1]->Receive();
+    }
+#else
+    // handle incoming signals
+    for(uint8_t i=ActiveReceiversNumber ; i > 0 ; i--){
+      ActiveReceivers[i - 1]->Receive();
+    }
+#endif
+    
+    // check for time overflow (one receiver per tick)
+    if(++ActiveReceiversTimeoutIndex >= ActiveReceiversNumber)
+      ActiveReceiversTimeoutIndex = 0;
+    ActiveReceivers[ActiveReceiversTimeoutIndex]->CheckTimeout();
+  } else if(ActiveTransmittersNumber == 0){
+    SC_Stop_Timer(); // nothing to do (restarted by Send() or Listen())
   }
+}
+
+
+#if SC_USE_PCINT
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// *************************************************************************
+// ***************************** PIN CHANGE ********************************
+// *************************************************************************
+
+// Handle the transitions for the receivers using the pin change engine
+//   (same for all ports >> each receiver checks its own pin)
+static void SC_Handle_Edges(void){
+  uint16_t timestamp = SC_Get_Timestamp();
   
-  // handle incoming signals
   for(uint8_t i=0 ; i < ReceiversNumber ; i++){
-    Receivers[i]->Receive();
+    Receivers[i]->Edge(timestamp);
   }
 }
 
+// -------------------------------------------------------------------------
+
+#if defined(PCINT0_vect)
+ISR(PCINT0_vect){
+  SC_Handle_Edges();
+}
+#endif
+
+#if defined(PCINT1_vect)
+ISR(PCINT1_vect){
+  SC_Handle_Edges();
+}
+#endif
+
+#if defined(PCINT2_vect)
+ISR(PCINT2_vect){
+  SC_Handle_Edges();
+}
+#endif
+
+#if defined(PCINT3_vect)
+ISR(PCINT3_vect){
+  SC_Handle_Edges();
+}
+#endif
+
+#endif //SC_USE_PCINT
+
+
+#if SC_USE_ICP || SC_USE_OC
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// *************************************************************************
+// ******************************* TIMER 1 *********************************
+// *************************************************************************
+
+#if SC_USE_ICP
+SCreceiver *SC_ICP_Receiver = NULL; // the receiver using the input capture engine (only one, on SC_ICP_PIN)
+#endif
+#if SC_USE_OC
+SCtransmitter *SC_OC_Transmitter = NULL; // the transmitter using the output compare engine (only one, on SC_OC_PIN)
+#endif
+
+// Start Timer 1 (16 bits, free running with a prescaler of 8)
+//  NOTE: the timer is not stopped afterwards
+void SC_Start_Timer1(void){
+  if(TCCR1B & 0x07)
+    return; //already running
+  
+  TCCR1A = 0x00; //normal mode
+  TCCR1B = T1_PRESCALER;
+}
+
+#if SC_USE_ICP
+
+// -------------------------------------------------------------------------
+
+// Input Capture Interrupt
+//   The counter is copied to ICR1 by the hardware on the transition,
+//   so the latency of the interrupt does not change the timestamp
+ISR(TIMER1_CAPT_vect){
+  uint16_t timestamp = ICR1;
+  uint8_t signal = (TCCR1B & _BV(ICES1)) ? HIGH : LOW; //rising edge >> the line is HIGH
+  
+  TCCR1B ^= _BV(ICES1); //capture the opposite edge next
+  TIFR1 = _BV(ICF1); //the flag must be cleared after changing the edge
+  
+  if(SC_ICP_Receiver != NULL)
+    SC_ICP_Receiver->Capture(timestamp, signal);
+}
+
+#endif //SC_USE_ICP
+
+#if SC_USE_OC
+
+// -------------------------------------------------------------------------
+
+// Output Compare A Interrupt
+//   The pin was already toggled by the hardware on the compare match,
+//   so the latency of the interrupt does not change the edge
+ISR(TIMER1_COMPA_vect){
+  if(SC_OC_Transmitter != NULL)
+    SC_OC_Transmitter->Compare();
+}
+
+#endif //SC_USE_OC
+
+#endif //SC_USE_ICP || SC_USE_OC
 
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -242,11 +618,27 @@ SCtransmitter::SCtransmitter(void){
   _id = 0;
   _channel = SC_DEFAULT_CHANNEL; //set channel
   _state = SC_STATE_IDLE;
+  _engine = SC_ENGINE_TIMER;
+  _code = SC_CODE_PWM;
+  _check_type = SC_CHECK_SUM;
+  _fec_type = SC_FEC_NONE;
   _start_duration_high = SC_DEFAULT_START_DURATION_HIGH;
   _start_duration_low = SC_DEFAULT_START_DURATION_LOW;
   _duration_high = SC_DEFAULT_DURATION_HIGH;
   _duration_low = SC_DEFAULT_DURATION_LOW;
   _buffer_length = 0;
+#if SC_TRANSMITTER_BUFFER
+  _frame = _buffer;
+#else
+  _frame = NULL; //set by Send()
+#endif
+  _source = SC_SOURCE_FRAME;
+  _burst = 1;
+  _queue = NULL;
+  _queue_size = 0;
+  _queue_head = 0;
+  _queue_tail = 0;
+  UpdateTicks();
 }
 
 //---------------
@@ -264,8 +656,123 @@ SCtransmitter::SCtransmitter(uint8_t pin){
 SCtransmitter::~SCtransmitter(void){
   Stop(); //just to be sure
   
+#if SC_USE_OC
+  //release the output compare engine
+  if(SC_OC_Transmitter == this)
+    SC_OC_Transmitter = NULL;
+#endif
+  
   //remove from the Transmitters list
-  RemoveTransmitter(this);
+  if(RemoveTransmitter(this))
+    RemoveTransmitterPort(_port_index);
+}
+
+// -------------------------------------------------------------------------
+
+// Start the transmission of the frame
+//  (returns 1)
+int8_t SCtransmitter::Begin(void){
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt can be sending the previous message
+  _index = 0; //reset
+  _bit = SC_FEC_FIRST_BIT(_fec_type); //reset (start with msb)
+  _ticks_left = 1; //send on the next tick
+  _signal_state = SC_START; //set initial signal to send
+  _signal = HIGH; //set for the 1st time
+  _burst_count = 0; //reset
+  _state = SC_STATE_SENDING; //set state
+  SREG = oldSREG;
+  
+#if SC_USE_OC
+  //toggle the pin on the compare matches of Timer 1
+  if(_engine == SC_ENGINE_OC){
+    SC_Start_Timer1();
+    oldSREG = SREG;
+    cli();
+    TCCR1A = (TCCR1A & ~(_BV(COM1A1) | _BV(COM1A0))) | _BV(COM1A1); //clear on compare
+    TCCR1C = _BV(FOC1A); //force the pin LOW
+    TCCR1A = (TCCR1A & ~(_BV(COM1A1) | _BV(COM1A0))) | _BV(COM1A0); //toggle on compare
+    OCR1A = TCNT1 + SC_US_TO_COUNTS(SC_T1_MIN_DURATION_INTERVAL); //1st edge (time to leave this function)
+    TIFR1 = _BV(OCF1A); //clear
+    TIMSK1 |= _BV(OCIE1A);
+    SREG = oldSREG;
+    return 1;
+  }
+#endif
+  
+  //add to the active transmitters & start timer if necessary
+  AddActiveTransmitter(this);
+  if(!SC_TIMER_STARTED)
+    SC_Start_Timer();
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Create the frame of the message in <frame>
+//  (returns the length of the frame)
+//  NOTE: the values must be already validated (see Send())
+//  NOTE: <prefix> is the 1st byte of the message if not NULL (see SendFragment()),
+//          so <length> includes it
+uint8_t SCtransmitter::Build(uint8_t *frame, const uint8_t *prefix, const uint8_t *message, uint8_t length){
+  uint8_t frame_length = 2;
+  
+  //create message
+  frame[0] = ((_id & 0x0F) << 4); //msb
+  frame[0] |= (_channel & 0x0F); //lsb
+  frame[1] = length;
+  if(prefix != NULL)
+    frame[frame_length++] = *prefix;
+  while(frame_length < (length + 2))
+    frame[frame_length++] = *message++;
+  
+  //append the check (the sum does not include the ID & length)
+  uint16_t check = SC_CHECK_INIT(_check_type);
+  for(uint8_t i = ((_check_type == SC_CHECK_SUM) ? 2 : 0) ; i < frame_length ; i++)
+    check = SC_Check_Update(_check_type, check, frame[i]);
+  if(_check_type == SC_CHECK_CRC16)
+    frame[frame_length++] = (check >> 8); //msb first
+  frame[frame_length++] = (check & 0xFF);
+  
+  return frame_length;
+}
+
+// -------------------------------------------------------------------------
+
+// Send the next signal with the output compare engine
+//  (the pin has just been toggled by the hardware)
+//  DO NOT call from outside the library (is public because of output compare interrupt)
+void SCtransmitter::Compare(void){
+#if SC_USE_OC
+  //check state
+  if(_state != SC_STATE_SENDING)
+    return;
+  
+  //check for end of transmission (the last LOW has finished)
+  if(_signal_state == SC_END){
+    //the pin is kept LOW if there was no frame in the queue (see below)
+    uint8_t restart = ((TCCR1A & (_BV(COM1A1) | _BV(COM1A0))) == _BV(COM1A1));
+    
+    if(!NextFrame()){
+      Stop();
+      return;
+    }
+    
+    //the frame was queued after the last LOW was set: start again from LOW
+    if(restart){
+      TCCR1A = (TCCR1A & ~(_BV(COM1A1) | _BV(COM1A0))) | _BV(COM1A0); //toggle on compare
+      OCR1A = TCNT1 + SC_US_TO_COUNTS(SC_T1_MIN_DURATION_INTERVAL); //1st edge
+      return;
+    }
+  }
+  
+  OCR1A += Next(); //edge of the next signal
+  
+  //keep the pin LOW at the end of the last signal (or send the next frame back to back)
+  if((_signal_state == SC_END) && (GetPending() <= 1))
+    TCCR1A = (TCCR1A & ~(_BV(COM1A1) | _BV(COM1A0))) | _BV(COM1A1); //clear on compare
+#endif
 }
 
 // -------------------------------------------------------------------------
@@ -276,23 +783,62 @@ void SCtransmitter::Create(uint8_t pin){
   if(_initialized)
     return;
   
+  //check pin
+  if(digitalPinToPort(pin) == NOT_A_PIN)
+    return;
+  
+  _pin = pin; //set pin
+  _port = portOutputRegister(digitalPinToPort(_pin)); //cache the register
+  _mask = digitalPinToBitMask(_pin); //cache the mask
+  
+  //add to the list of ports
+  _port_index = AddTransmitterPort(_port);
+  if(_port_index == 0xFF)
+    return;
+  
   //add to the Transmitters list
-  if(!AddTransmitter(this))
+  if(!AddTransmitter(this)){
+    RemoveTransmitterPort(_port_index);
     return;
+  }
   
   _initialized = 1;
   
-  _pin = pin; //set pin
   pinMode(_pin, OUTPUT); //set as output
   _id = 0;
   _channel = SC_DEFAULT_CHANNEL; //set channel
   _state = SC_STATE_IDLE;
+  _engine = SC_ENGINE_TIMER;
+  _code = SC_CODE_PWM;
+  _check_type = SC_CHECK_SUM;
+  _fec_type = SC_FEC_NONE;
   _start_duration_high = SC_DEFAULT_START_DURATION_HIGH;
   _start_duration_low = SC_DEFAULT_START_DURATION_LOW;
   _duration_high = SC_DEFAULT_DURATION_HIGH;
   _duration_low = SC_DEFAULT_DURATION_LOW;
   _buffer_length = 0;
-  digitalWrite(_pin, LOW); //send idle value
+#if SC_TRANSMITTER_BUFFER
+  _frame = _buffer;
+#else
+  _frame = NULL; //set by Send()
+#endif
+  _source = SC_SOURCE_FRAME;
+  _burst = 1;
+  _queue = NULL;
+  _queue_size = 0;
+  _queue_head = 0;
+  _queue_tail = 0;
+  UpdateTicks();
+  Stop(); //send idle value
+}
+
+// -------------------------------------------------------------------------
+
+// Wait until all the frames are sent
+//  NOTE: the timer (or Timer 1 for the output compare engine) must be running
+void SCtransmitter::Flush(void){
+  while(*(volatile uint8_t *)&_state == SC_STATE_SENDING)
+    ; //changed in the interrupt at the end of the last frame
 }
 
 // -------------------------------------------------------------------------
@@ -304,6 +850,27 @@ uint8_t SCtransmitter::GetChannel(void){
 
 // -------------------------------------------------------------------------
 
+// Get the check of the frame (SC_CHECK_x)
+uint8_t SCtransmitter::GetCheck(void){
+  return _check_type;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the line code of the bits (SC_CODE_x)
+uint8_t SCtransmitter::GetCode(void){
+  return _code;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the correction of the frame (SC_FEC_x)
+uint8_t SCtransmitter::GetCorrection(void){
+  return _fec_type;
+}
+
+// -------------------------------------------------------------------------
+
 // Get the high time duration for the ONE interval in [us]
 uint16_t SCtransmitter::GetDurationHIGH(void){
   return _duration_high;
@@ -318,6 +885,33 @@ uint16_t SCtransmitter::GetDurationLOW(void){
 
 // -------------------------------------------------------------------------
 
+// Get the engine used to send the signals
+uint8_t SCtransmitter::GetEngine(void){
+  return _engine;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of frames not yet sent (including the one being sent)
+uint8_t SCtransmitter::GetPending(void){
+  if(_state != SC_STATE_SENDING)
+    return 0;
+  
+  if(_queue == NULL)
+    return 1;
+  
+  //the frame being sent is at the tail (unless sent without copy)
+  uint8_t head = _queue_head;
+  uint8_t tail = _queue_tail; //changed in the interrupt
+  uint8_t pending = (_source == SC_SOURCE_FRAME) ? 0 : 1;
+  if(head >= tail)
+    return (pending + head - tail);
+  else
+    return (pending + _queue_size - tail + head);
+}
+
+// -------------------------------------------------------------------------
+
 // Get the associated pin
 uint8_t SCtransmitter::GetPin(void){
   return _pin;
@@ -346,6 +940,24 @@ uint8_t SCtransmitter::GetState(void){
 
 // -------------------------------------------------------------------------
 
+// Check if Send() can be called without overwriting a frame
+//  (returns 1 if idle or with a free slot in the queue, 0 otherwise)
+uint8_t SCtransmitter::isReady(void){
+  //check if initialized
+  if(!_initialized)
+    return 0;
+  
+  if(_queue == NULL)
+    return ((_state == SC_STATE_SENDING) ? 0 : 1);
+  
+  uint8_t head = _queue_head + 1;
+  if(head >= _queue_size)
+    head = 0;
+  return ((head == _queue_tail) ? 0 : 1); //one slot is always free
+}
+
+// -------------------------------------------------------------------------
+
 // Check if is sending
 //  (returns 1 if sending, 0 otherwise)
 uint8_t SCtransmitter::isSending(void){
@@ -364,79 +976,301 @@ uint8_t SCtransmitter::isSending(void){
 
 // Send the message with given length
 //  (returns 1 on start of transmission, -1 if not initialized,
-//    -2 if invalid ID, -3 if invalid channel, -4 if invalid length)
+//    -2 if invalid ID, -3 if invalid channel, -4 if invalid length,
+//    -5 if there is no queue and SC_TRANSMITTER_BUFFER is 0)
+//  NOTE: with a queue (see SetQueue()), returns 1 when the message is queued
+//          and 0 if the queue is full (the current frame is not overwritten)
 int8_t SCtransmitter::Send(uint8_t *message, uint8_t length){
-  //check if initialized
-  if(!_initialized)
-    return -1;
-  
-  //check id
-  if(_id == 0)
-    return -2;
-  if((_id & 0xF) == 0)
-    return -2;
-    
-  //check channel
-  if(_channel == 0)
-    return -3;
-  if((_channel & 0xF) == 0)
-    return -3;
-  
-  //check message size
-  if(length > SC_MESSAGE_SIZE)
-    return -4;
-  
-  //start timer if necessary
-  if(!SC_TIMER_STARTED)
-    SC_Start_Timer();
-  
-  //create message
-  _buffer[0] = ((_id & 0x0F) << 4); //msb
-  _buffer[0] |= (_channel & 0x0F); //lsb
-  _buffer[1] = length;
-  for(uint8_t i=0 ; i < length ; i++)
-    _buffer[i+2] = message[i];
-  _buffer[length + 2] = SC_CheckSum(message, length);
-  _buffer_length = length + 3;
-  
-  _elapsed_time = 0; //reset
-  _state = SC_STATE_SENDING; //set state
-  _signal_state = SC_START; //set initial signal to send
-  _signal = HIGH; //set for the 1st time
-  
-  return 1;
-}
-
-// -------------------------------------------------------------------------
-
-// Set the channel to transmit
-void SCtransmitter::SetChannel(uint8_t channel){
-  _channel = (channel & 0xF); //assign only 4 bits
+  return SendFrame(NULL, message, length);
 }
 
 // -------------------------------------------------------------------------
 
-// Set the ID of the receiver
-void SCtransmitter::SetID(uint8_t id){
-  _id = (id & 0xF); //asssign only 4 bits
+// Send a fragment of a large message (the control byte & the data)
+//  (same returns of Send())
+//  NOTE: the data is copied once, in the frame (see SCfragmenter::Update())
+int8_t SCtransmitter::SendFragment(uint8_t control, const uint8_t *data, uint8_t size){
+  return SendFrame(&control, data, size + 1);
 }
 
 // -------------------------------------------------------------------------
 
-// Set the high and low times for the ONE signal in [us]
+// Send the message with given length (and the prefix as its 1st byte if not NULL)
+//  (see Send())
+int8_t SCtransmitter::SendFrame(const uint8_t *prefix, const uint8_t *message, uint8_t length){
+  int8_t res = Validate(length);
+  if(res != 1)
+    return res;
+  
+  if(_queue != NULL){
+    //check for free slot (one is always free)
+    uint8_t head = _queue_head + 1;
+    if(head >= _queue_size)
+      head = 0;
+    if(head == _queue_tail)
+      return 0; //full
+    
+    //create the frame in the free slot (not used by the interrupt)
+    _queue[_queue_head].length = Build(_queue[_queue_head].data, prefix, message, length);
+    
+    uint8_t oldSREG = SREG;
+    cli(); //the interrupt checks the queue at the end of each frame
+    _queue_head = head;
+    if(_state == SC_STATE_SENDING){
+      SREG = oldSREG;
+      return 1; //sent after the current frame
+    }
+    SREG = oldSREG;
+    
+    //send the oldest frame (the transmitter is idle)
+    _frame = _queue[_queue_tail].data;
+    _buffer_length = _queue[_queue_tail].length;
+  } else {
+#if SC_TRANSMITTER_BUFFER
+    //create message
+    _buffer_length = Build(_buffer, prefix, message, length);
+    _frame = _buffer;
+#else
+    return -5; //no buffer for the frame
+#endif
+  }
+  _source = SC_SOURCE_FRAME;
+  
+  return Begin();
+}
+
+// -------------------------------------------------------------------------
+
+// Send the message with given length without copying it
+//  (same returns of Send(), but 0 if the queue is not empty)
+//  NOTE: the message is read while it is sent, so <message> must not change
+//          until the transmission ends (see isSending() and Flush())
+//  NOTE: the ID, length & check are created on the fly
+int8_t SCtransmitter::SendBuffer(const uint8_t *message, uint8_t length){
+  return SendFrom(message, length, SC_SOURCE_RAM);
+}
+
+// -------------------------------------------------------------------------
+
+// Send the message with given length stored in the flash memory (PROGMEM)
+//  (same returns of SendBuffer())
+int8_t SCtransmitter::Send_P(const uint8_t *message, uint8_t length){
+  return SendFrom(message, length, SC_SOURCE_PROGMEM);
+}
+
+// -------------------------------------------------------------------------
+
+// Send the message from the given memory (SC_SOURCE_x) without copying it
+//  (see SendBuffer())
+int8_t SCtransmitter::SendFrom(const uint8_t *message, uint8_t length, uint8_t source){
+  int8_t res = Validate(length);
+  if(res != 1)
+    return res;
+  
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt can be sending the previous message
+  //do not overwrite the frames of the queue
+  if((_queue != NULL) && (_state == SC_STATE_SENDING)){
+    SREG = oldSREG;
+    return 0;
+  }
+  _header[0] = ((_id & 0x0F) << 4); //msb
+  _header[0] |= (_channel & 0x0F); //lsb
+  _header[1] = length;
+  _payload = message;
+  _buffer_length = length + 2 + SC_CHECK_SIZE(_check_type); //ID+Channel & Length & Check
+  _check = SC_CHECK_INIT(_check_type);
+  _source = source;
+  SREG = oldSREG;
+  
+  return Begin();
+}
+
+// -------------------------------------------------------------------------
+
+// Set the number of frames sent after one START (1 to disable)
+//  (returns 0 on invalid number or 1 if successful)
+//  NOTE: only the frames of the queue are sent in burst (see SetQueue()),
+//          back to back without the START of each frame
+//  NOTE: the SCreceiver needs a queue to receive the frames of a burst
+//          (the frames can have other IDs, but the rest of the burst is lost
+//          after an invalid frame)
+//  NOTE: ignored with SC_CODE_MANCHESTER (each frame starts with the START)
+uint8_t SCtransmitter::SetBurst(uint8_t frames){
+  //check number
+  if(frames == 0)
+    return 0;
+  
+  _burst = frames;
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the channel to transmit
+void SCtransmitter::SetChannel(uint8_t channel){
+  _channel = (channel & 0xF); //assign only 4 bits
+}
+
+// -------------------------------------------------------------------------
+
+// Set the check of the frame (SC_CHECK_x)
+//  (returns 0 on invalid type or 1 if successful)
+//  NOTE: must call Send() again after changing the check
+//  NOTE: must match the check of the SCreceiver
+uint8_t SCtransmitter::SetCheck(uint8_t type){
+  //check type
+  if((type != SC_CHECK_SUM) && (type != SC_CHECK_CRC8) && (type != SC_CHECK_CRC16))
+    return 0;
+  
+  Stop(); //stop the transmission before changing the check
+  _check_type = type;
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the line code of the bits (SC_CODE_x)
+//  (returns 0 on invalid code or 1 if successful)
+//  NOTE: must call Send() again after changing the code
+//  NOTE: must match the code of the SCreceiver
+//  NOTE: the times are corrected for the levels of the code (see SetInterval())
+//  NOTE: the frames of SC_CODE_MANCHESTER are not sent in burst (see SetBurst())
+uint8_t SCtransmitter::SetCode(uint8_t code){
+  //check code
+  if((code != SC_CODE_PWM) && (code != SC_CODE_PWM4) && (code != SC_CODE_MANCHESTER))
+    return 0;
+  
+  Stop(); //stop the transmission before changing the code
+  _code = code;
+  
+  return SetInterval(_duration_high, _duration_low); //correct the times
+}
+
+// -------------------------------------------------------------------------
+
+// Set the correction of the frame (SC_FEC_x)
+//  (returns 0 on invalid type or 1 if successful)
+//  NOTE: must call Send() again after changing the correction
+//  NOTE: must match the correction of the SCreceiver
+//  NOTE: SC_FEC_HAMMING doubles the bits of the frame (see SC_FEC_Encode())
+uint8_t SCtransmitter::SetCorrection(uint8_t type){
+  //check type
+  if((type != SC_FEC_NONE) && (type != SC_FEC_HAMMING))
+    return 0;
+  
+  Stop(); //stop the transmission before changing the correction
+  _fec_type = type;
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the engine used to send the signals
+//  (returns 0 on invalid engine or 1 if successful)
+//  NOTE: SC_ENGINE_OC is only available if SC_USE_OC is set, for
+//          a single transmitter on SC_OC_PIN (set the engine before
+//          setting times shorter than SC_MIN_DURATION)
+//  NOTE: the shortest signal must be longer than the latency of the
+//          interrupt, otherwise the compare match is missed
+uint8_t SCtransmitter::SetEngine(uint8_t engine){
+  //check engine
+  if(engine == SC_ENGINE_OC){
+#if SC_USE_OC && defined(SC_OC_PIN)
+    if(!_initialized)
+      return 0;
+    if(_pin != SC_OC_PIN)
+      return 0;
+    if((SC_OC_Transmitter != NULL) && (SC_OC_Transmitter != this))
+      return 0; //already used by another transmitter
+#else
+    return 0;
+#endif
+  } else if(engine != SC_ENGINE_TIMER){
+    return 0;
+  }
+  
+  Stop(); //stop the transmission before changing the engine
+  _engine = engine;
+  
+#if SC_USE_OC
+  if(_engine == SC_ENGINE_OC){
+    SC_OC_Transmitter = this; //reserve the output compare engine
+  } else {
+    if(SC_OC_Transmitter == this)
+      SC_OC_Transmitter = NULL; //release
+    
+    //restore the default times if too short for the timer engine
+    if((((uint32_t)_duration_high + _duration_low) < SC_MIN_DURATION) || (_duration_high < SC_MIN_DURATION_INTERVAL) || (_duration_low < SC_MIN_DURATION_INTERVAL)){
+      _duration_high = SC_DEFAULT_DURATION_HIGH;
+      _duration_low = SC_DEFAULT_DURATION_LOW;
+    }
+  }
+#endif
+  
+  UpdateTicks();
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the ID of the receiver
+void SCtransmitter::SetID(uint8_t id){
+  _id = (id & 0xF); //asssign only 4 bits
+}
+
+// -------------------------------------------------------------------------
+
+// Set all the times at once, without correction (see SCtransmitterT)
+void SCtransmitter::SetTimes(uint16_t high_time, uint16_t low_time, uint16_t start_high_time, uint16_t start_low_time){
+  Stop(); //stop the transmission before changing values
+  
+  _duration_high = high_time;
+  _duration_low = low_time;
+  _start_duration_high = start_high_time;
+  _start_duration_low = start_low_time;
+  
+  UpdateTicks();
+}
+
+// -------------------------------------------------------------------------
+
+// Set the high and low times for the ONE signal in [us]
 //  (returns 0 on invalid values or 1 if successful)
 //  NOTE: must call Send() again after changing the values
 //  NOTE: ZERO signal has the same times but with the order inverted
+//  NOTE: with SC_CODE_PWM4, the difference of the times is at least 3 times
+//          the one of the ONE & ZERO (see SetCode())
+//  NOTE: with SC_CODE_MANCHESTER, the LOW time is half of the period of the
+//          bit and the HIGH time is corrected to the period
 //  NOTE: all values must match the correspondant values in SCtransmitter
 //  NOTE: the functions automatically corrects values if they are
 //          incompatible with library definitions
 uint8_t SCtransmitter::SetInterval(uint16_t high_time, uint16_t low_time){
+  uint16_t deviation = SC_SIGNAL_DEVIATION;
+  uint16_t min_duration = SC_MIN_DURATION;
+  uint16_t min_interval = SC_MIN_DURATION_INTERVAL;
+#if SC_USE_OC
+  if(_engine == SC_ENGINE_OC){ //the transitions are generated by the hardware
+    deviation = SC_T1_SIGNAL_DEVIATION;
+    min_duration = SC_T1_MIN_DURATION;
+    min_interval = SC_T1_MIN_DURATION_INTERVAL;
+  }
+#endif
+  
+  uint16_t separation = 2 * deviation;
+  if(_code == SC_CODE_PWM4)
+    separation *= 3; //4 levels between the times (see SetCode())
+  
   //check values
-  if((high_time + low_time) < SC_MIN_DURATION)
+  if((high_time + low_time) < min_duration)
     return 0;
-  if(high_time < SC_MIN_DURATION_INTERVAL)
+  if(high_time < min_interval)
     return 0;
-  if(low_time < SC_MIN_DURATION_INTERVAL)
+  if(low_time < min_interval)
     return 0;
   
   Stop(); //stop the transmission before changing values
@@ -452,30 +1286,64 @@ uint8_t SCtransmitter::SetInterval(uint16_t high_time, uint16_t low_time){
   else
     _duration_low = low_time;
   
+  //the HIGH time is the period of the bit (see SetCode())
+  if(_code == SC_CODE_MANCHESTER){
+    if(_duration_low > (SC_SIGNAL_MAX_TIME / 2))
+      _duration_low = SC_SIGNAL_MAX_TIME / 2;
+    _duration_high = 2 * _duration_low;
+  }
+  
   //check difference
-  if(abs(_duration_high - _duration_low) < (2 * SC_SIGNAL_DEVIATION)){
+  if(abs(_duration_high - _duration_low) < separation){
     if(_duration_high >= _duration_low){
-      _duration_low = _duration_high - 2 * SC_SIGNAL_DEVIATION;
-      if(_duration_low < SC_MIN_DURATION_INTERVAL){ //check for low limit
-        _duration_low = SC_MIN_DURATION_INTERVAL;
-        _duration_high = _duration_low + 2 * SC_SIGNAL_DEVIATION;
+      if(_duration_high < (min_interval + separation)){ //check for low limit
+        _duration_low = min_interval;
+        _duration_high = _duration_low + separation;
+      } else {
+        _duration_low = _duration_high - separation;
       }
       if(_duration_high > SC_SIGNAL_MAX_TIME){ //SHOULD NEVER ENTER HERE !!! (means wrong value definitions)
         _state = SC_STATE_ERROR_DEFINITIONS;
         return 0;
       }
     } else {
-      _duration_high = _duration_low - 2 * SC_SIGNAL_DEVIATION;
-      if(_duration_high < SC_MIN_DURATION_INTERVAL){ //check for low limit
-        _duration_high = SC_MIN_DURATION_INTERVAL;
-        _duration_low = _duration_low + 2 * SC_SIGNAL_DEVIATION;
+      if(_duration_low < (min_interval + separation)){ //check for low limit
+        _duration_high = min_interval;
+        _duration_low = _duration_high + separation;
+      } else {
+        _duration_high = _duration_low - separation;
       }
-      if(_duration_low > SC_SIGNAL_MAX_TIME) //SHOULD NEVER ENTER HERE !!! (means wrong value definitions)
+      if(_duration_low > SC_SIGNAL_MAX_TIME){ //SHOULD NEVER ENTER HERE !!! (means wrong value definitions)
         _state = SC_STATE_ERROR_DEFINITIONS;
         return 0;
+      }
     }
   }
   
+  UpdateTicks();
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the queue of frames of the transmitter
+//  (returns 0 on invalid values or 1 if successful)
+//  NOTE: the queue holds <number> - 1 frames, including the one being sent
+//  NOTE: the frames are sent back to back (see Send(), Flush() and GetPending())
+//  NOTE: <slots> can be NULL to send only one frame at a time (default)
+uint8_t SCtransmitter::SetQueue(SCframe *slots, uint8_t number){
+  //check values
+  if((slots != NULL) && (number < 2))
+    return 0;
+  
+  Stop(); //stop the transmission before changing the queue
+  
+  _queue = slots;
+  _queue_size = (slots != NULL) ? number : 0;
+  _queue_head = 0; //reset
+  _queue_tail = 0; //reset
+  
   return 1;
 }
 
@@ -509,6 +1377,8 @@ uint8_t SCtransmitter::SetStart(uint16_t high_time, uint16_t low_time){
   else
     _start_duration_low = low_time;
   
+  UpdateTicks();
+  
   return 1;
 }
 
@@ -517,17 +1387,211 @@ uint8_t SCtransmitter::SetStart(uint16_t high_time, uint16_t low_time){
 // Stop the communication
 void SCtransmitter::Stop(void){
   _state = SC_STATE_IDLE; //reset
-  digitalWrite(_pin, LOW); //reset signal
+  RemoveActiveTransmitter(this);
+  
+  //check if initialized (pin not set otherwise)
+  if(!_initialized)
+    return;
+  
+  uint8_t oldSREG = SREG;
+  cli(); //the timer interrupt can write to the same port
+  _queue_tail = _queue_head; //discard the frames not sent
+#if SC_USE_OC
+  //disconnect the pin from the output compare unit
+  if(_engine == SC_ENGINE_OC){
+    TIMSK1 &= ~_BV(OCIE1A);
+    TCCR1A &= ~(_BV(COM1A1) | _BV(COM1A0));
+  }
+#endif
+  SC_PIN_WRITE(LOW); //reset signal
+  SREG = oldSREG;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the byte of the frame at <_index>
+//  NOTE: without a frame (see SendBuffer()), the ID, length & check are
+//          created on the fly and the message is read from its memory
+inline uint8_t SCtransmitter::Load(void){
+  if(_source == SC_SOURCE_FRAME)
+    return _frame[_index];
+  
+  uint8_t value;
+  if(_index < 2){ //ID+Channel & Length
+    value = _header[_index];
+  } else if(_index < (_header[1] + 2)){ //message
+    if(_source == SC_SOURCE_PROGMEM)
+      value = pgm_read_byte(_payload + _index - 2);
+    else
+      value = _payload[_index - 2];
+  } else { //check (msb first)
+    if((_check_type == SC_CHECK_CRC16) && (_index == (_header[1] + 2)))
+      return (_check >> 8);
+    return (_check & 0xFF);
+  }
+  
+  //update the check (the sum does not include the ID & length)
+  if((_index >= 2) || (_check_type != SC_CHECK_SUM))
+    _check = SC_Check_Update(_check_type, _check, value);
+  
+  return value;
+}
+
+// -------------------------------------------------------------------------
+
+// Prepare the symbol of the next bit of the frame (or the end of the frame)
+inline void SCtransmitter::Prepare(void){
+  //check what is the next data to send
+  if(_index >= _buffer_length){ //no more data
+    _signal_state = SC_END;
+  } else {
+    if(_bit == SC_FEC_FIRST_BIT(_fec_type)){ //new byte
+      _data = Load();
+      if(_fec_type == SC_FEC_HAMMING)
+        _data = SC_FEC_Encode(_data);
+    }
+    if(_code == SC_CODE_PWM4){ //next 2 bits
+      uint8_t value = (_data >> (_bit - 1)) & 0x03;
+      if(value == 0x03)
+        _signal_state = SC_ONE;
+      else if(value == 0x00)
+        _signal_state = SC_ZERO;
+      else
+        _signal_state = SC_SYMBOL_1 + value - 1;
+      _bit -= 2;
+    } else {
+      if(_data & ((uint16_t)1 << _bit)) //next bit is 1
+        _signal_state = SC_ONE;
+      else //next bit is 0
+        _signal_state = SC_ZERO;
+      _bit--;
+    }
+    
+    //check for byte sent
+    if(_bit < 0){
+      _bit = SC_FEC_FIRST_BIT(_fec_type);
+      _index++;
+    }
+  }
+}
+
+// -------------------------------------------------------------------------
+
+// Prepare the signal after the one just sent
+//  (returns the duration of the signal just sent, in the units of the engine)
+inline uint16_t SCtransmitter::Next(void){
+  uint16_t duration;
+  
+  if(_code == SC_CODE_MANCHESTER)
+    return NextHalf();
+  
+  if(_signal == HIGH){
+    duration = _ticks[_signal_state][0]; //HIGH of the symbol
+    _signal = LOW; //next signal is LOW
+  } else {
+    duration = _ticks[_signal_state][1]; //LOW of the symbol
+    _signal = HIGH; //next signal is HIGH
+    Prepare();
+  }
+  
+  return duration;
+}
+
+// -------------------------------------------------------------------------
+
+// Prepare the signal after the one just sent with SC_CODE_MANCHESTER
+//  (returns the duration of the signal just sent, in the units of the engine)
+//  NOTE: the 2nd half of a bit joins the 1st half of the next bit when both
+//          have the same level, so a signal lasts half or all the period
+//  NOTE: the LOW of the START joins the 1st half of the 1st bit if it is a ZERO
+inline uint16_t SCtransmitter::NextHalf(void){
+  uint16_t duration = _ticks[SC_ONE][1]; //half of the period
+  
+  if(_signal_state == SC_START){
+    if(_signal == HIGH){
+      duration = _ticks[SC_START][0];
+    } else {
+      duration = _ticks[SC_START][1];
+      Prepare(); //1st bit
+      _half = 0; //start of the bit
+      if(_signal_state == SC_ZERO){
+        duration += _ticks[SC_ONE][1];
+        _half = 1; //middle of the bit
+      }
+    }
+  } else if(_half == 0){ //1st half (the level changes in the middle of the bit)
+    _half = 1;
+  } else if(_half == 1){ //2nd half
+    uint8_t previous = _signal_state;
+    Prepare();
+    if(_signal_state == SC_END){
+      //end with a LOW, so the next START is not joined to a HIGH
+      if(_signal == HIGH){
+        _signal_state = previous;
+        _half = 2;
+      }
+    } else if(_signal_state != previous){ //the 1st half of the next bit has the same level
+      duration = _ticks[SC_ONE][0]; //period
+    } else {
+      _half = 0;
+    }
+  } else { //LOW after the last bit
+    _signal_state = SC_END;
+  }
+  
+  _signal = !_signal; //the level changes on every signal
+  return duration;
 }
 
+// -------------------------------------------------------------------------
+
+// Prepare the next frame of the queue (the last LOW of the frame has just finished)
+//  (returns 1 if there is a frame to send, 0 otherwise)
+uint8_t SCtransmitter::NextFrame(void){
+  //check for queue
+  if(_queue == NULL)
+    return 0;
+  
+  //free the slot of the frame just sent (not in the queue if sent without copy)
+  uint8_t tail = _queue_tail;
+  if(_source == SC_SOURCE_FRAME){
+    if(++tail >= _queue_size)
+      tail = 0;
+    _queue_tail = tail;
+  }
+  
+  //check for empty queue
+  if(tail == _queue_head)
+    return 0;
+  
+  _source = SC_SOURCE_FRAME;
+  _frame = _queue[tail].data;
+  _buffer_length = _queue[tail].length;
+  _index = 0; //reset
+  _bit = SC_FEC_FIRST_BIT(_fec_type); //reset (start with msb)
+  _signal = HIGH; //set for the 1st time
+  
+  //send the frame without START if it is part of the burst (see SetBurst())
+  if((++_burst_count < _burst) && (_code != SC_CODE_MANCHESTER)){
+    Prepare(); //1st bit
+  } else {
+    _burst_count = 0; //reset
+    _signal_state = SC_START; //set initial signal to send
+  }
+  
+  return 1;
+}
+
+
 // -------------------------------------------------------------------------
 
 // Transmit the message
 void SCtransmitter::Transmit(void){
   /*
       1) check if sending
-      2) update elapsed time
-      3) send signal
+      2) count down the ticks of the current signal
+      3) send the next signal (when the count reaches 0)
+      4) load the ticks of the next signal & prepare the following one
       
       {ID+Chn, Len,   mes,    CS} --> (message to send)
       {0x11, 0x03, 1, 2, 3, 0x06} --> {00010001, 00000011, 00000001, 00000010, 00000011, 00000110}
@@ -541,79 +1605,89 @@ void SCtransmitter::Transmit(void){
   if(_state != SC_STATE_SENDING)
     return;
   
-  _elapsed_time += SC_TIMER_INTERVAL; //update
-  
-  if(_signal_state == SC_START){ // send START
-    digitalWrite(_pin, _signal);
-    if((_elapsed_time >= _start_duration_high) && (_signal == HIGH)){ //finished with HIGH
-      _elapsed_time = 0; //reset
-      _signal = LOW; //next signal is LOW
-    } else if ((_elapsed_time >= _start_duration_low) && (_signal == LOW)){ //finished with START
-      _elapsed_time = 0; //reset
-      _signal = HIGH; //next signal is HIGH
-      _index = 0; //reset
-      _bit = 7; //reset (start with msb)
-      
-      if(_index >= _buffer_length) //no more data
-        Stop();
-      else if(_buffer[_index] & (1 << _bit)) //next byte is 1
-        _signal_state = SC_ONE;
-      else //next byte is 0
-        _signal_state = SC_ZERO;
-    }
-  } else if(_signal_state == SC_ONE){ // send ONE
-    digitalWrite(_pin, _signal);
-    if((_elapsed_time >= _duration_high) && (_signal == HIGH)){ //finished with HIGH
-      _elapsed_time = 0; //reset
-      _signal = LOW; //next signal is LOW
-    } else if ((_elapsed_time >= _duration_low) && (_signal == LOW)){ //finished with ONE
-      _elapsed_time = 0; //reset
-      _signal = HIGH; //next signal is HIGH
-      _bit--; //decrease
-      
-      //check for byte sent
-      if(_bit < 0){
-        _bit = 7;
-        _index++;
-      }
-      
-      //check what is the next data to send
-      if(_index >= _buffer_length) //no more data
-        Stop();
-      else if(_buffer[_index] & (1 << _bit)) //next byte is 1
-        _signal_state = SC_ONE;
-      else //next byte is 0
-        _signal_state = SC_ZERO;
+  //check if the current signal has finished
+  if(--_ticks_left)
+    return;
+  
+  //check for end of transmission (or send the next frame back to back)
+  if(_signal_state == SC_END){
+    if(!NextFrame()){
+      Stop();
+      return;
     }
-  } else if(_signal_state == SC_ZERO){ // send ZERO
-    digitalWrite(_pin, _signal);
-    if((_elapsed_time >= _duration_low) && (_signal == HIGH)){ //finished with HIGH
-      _elapsed_time = 0; //reset
-      _signal = LOW; //next signal is LOW
-    } else if ((_elapsed_time >= _duration_high) && (_signal == LOW)){ //finished with ONE
-      _elapsed_time = 0; //reset
-      _signal = HIGH; //next signal is HIGH
-      _bit--; //decrease
-      
-      //check for byte sent
-      if(_bit < 0){
-        _bit = 7;
-        _index++;
+  }
+  
+#if SC_FAST_IO
+  //write together with the other pins of the port (see SC_Timer_Tick())
+  if(_signal)
+    TransmitterPortsSet[_port_index] |= _mask;
+  else
+    TransmitterPortsClear[_port_index] |= _mask;
+#else
+  SC_PIN_WRITE(_signal);
+#endif
+  
+  _ticks_left = Next();
+}
+
+// -------------------------------------------------------------------------
+
+// Update the duration of each signal in the units of the engine
+//  (called when the durations or the engine change)
+void SCtransmitter::UpdateTicks(void){
+  int16_t step = ((int16_t)_duration_high - (int16_t)_duration_low) / 3; //between the levels of SC_CODE_PWM4
+  uint16_t times[6][2] = {
+    {_duration_low, _duration_high}, //ZERO (inverted)
+    {_duration_high, _duration_low}, //ONE
+    {_start_duration_high, _start_duration_low}, //START
+    {0, 0}, //END (not sent)
+    {(uint16_t)(_duration_low + step), (uint16_t)(_duration_high - step)}, //SYMBOL_1
+    {(uint16_t)(_duration_high - step), (uint16_t)(_duration_low + step)} //SYMBOL_2
+  };
+  
+  for(uint8_t i=0 ; i < 6 ; i++){
+    for(uint8_t j=0 ; j < 2 ; j++){
+#if SC_USE_OC
+      if(_engine == SC_ENGINE_OC){ //in counts of Timer 1
+        uint32_t counts = SC_US_TO_COUNTS(times[i][j]);
+        _ticks[i][j] = (counts > 0xFFFF) ? 0xFFFF : counts;
+        continue;
       }
-      
-      //check what is the next data to send
-      if(_index >= _buffer_length) //no more data
-        Stop();
-      else if(_buffer[_index] & (1 << _bit)) //next byte is 1
-        _signal_state = SC_ONE;
-      else //next byte is 0
-        _signal_state = SC_ZERO;
+#endif
+      _ticks[i][j] = SC_US_TO_TICKS(times[i][j]);
     }
-  } else { // end of transmission
-    Stop();
   }
 }
 
+// -------------------------------------------------------------------------
+
+// Validate the values of the transmission
+//  (returns 1 if valid, -1 if not initialized, -2 if invalid ID,
+//    -3 if invalid channel, -4 if invalid length)
+int8_t SCtransmitter::Validate(uint8_t length){
+  //check if initialized
+  if(!_initialized)
+    return -1;
+  
+  //check id
+  if(_id == 0)
+    return -2;
+  if((_id & 0xF) == 0)
+    return -2;
+    
+  //check channel
+  if(_channel == 0)
+    return -3;
+  if((_channel & 0xF) == 0)
+    return -3;
+  
+  //check message size
+  if(length > SC_MESSAGE_SIZE)
+    return -4;
+  
+  return 1;
+}
+
 
 //---------------------------------------------------------------------------------------------------------------------
 
@@ -630,13 +1704,31 @@ SCreceiver::SCreceiver(){
   _id = 0; //not initialized
   _channel = SC_DEFAULT_CHANNEL; //set channel
   _state = SC_STATE_IDLE;
-  _signal[0] = 0;
-  _signal[1] = 0;
+  _engine = SC_ENGINE_TIMER;
+  _code = SC_CODE_PWM;
+  _check_type = SC_CHECK_SUM;
+  _fec_type = SC_FEC_NONE;
+  _pulse = 0;
+  _half = SC_HALF_NONE;
+  _auto_baud = 0;
+  _scale = 256;
+  _filtered = 0;
+  _dropped = 0;
+  _corrected = 0;
+  _queue = NULL;
+  _queue_size = 0;
+  _queue_head = 0;
+  _queue_tail = 0;
+  _frame = _buffer;
+  _borrowed = 0;
+  _handler = NULL;
   _start_duration_high = SC_DEFAULT_START_DURATION_HIGH;
   _start_duration_low = SC_DEFAULT_START_DURATION_LOW;
   _duration_high = SC_DEFAULT_DURATION_HIGH;
   _duration_low = SC_DEFAULT_DURATION_LOW;
   _buffer_length = 0;
+  _skip_bits = 0;
+  UpdateWindows();
 }
 
 //---------------
@@ -654,61 +1746,245 @@ SCreceiver::SCreceiver(uint8_t pin, uint8_t id){
 SCreceiver::~SCreceiver(void){
   Stop();
   
+#if SC_USE_ICP
+  //release the input capture engine
+  if(SC_ICP_Receiver == this)
+    SC_ICP_Receiver = NULL;
+#endif
+  
   //remove from the Receivers list
-  RemoveReceiver(this);
+  if(RemoveReceiver(this))
+    RemoveReceiverPort(_port_index);
 }
 
 // -------------------------------------------------------------------------
 
-// Manually reset buffer so one can identify when new message has arrived
-//  (returns 0 if no message, 1 otherwise)
-//  NOTE: returns the state to SC_STATE_LISTENNING
-uint8_t SCreceiver::ClearBuffer(void){
-  //only clear if there is a message
-  if(_state != SC_STATE_MESSAGE_READY)
-    return 0;
+// Handle a transition found by the input capture engine
+//  (<timestamp> in counts of Timer 1, <signal> is the level after the transition)
+//  DO NOT call from outside the library (is public because of input capture interrupt)
+void SCreceiver::Capture(uint16_t timestamp, uint8_t signal){
+  //check state
+  if((_state != SC_STATE_LISTENNING) && (_state != SC_STATE_MESSAGE_READY))
+    return;
   
-  for(uint8_t i=0 ; i < SC_TOTAL_MESSAGE_SIZE ; i++)
-    _buffer[i] = 0;
-  _buffer_length = 0;
-  _state = SC_STATE_LISTENNING;
-  _signal_state = 0;
-  return 1;
+  CheckTimeout(); //the time overflow is checked only once every few ticks
+  
+  if(signal != _previous_signal){ //transition (an edge can be lost if the pulse is too short)
+    if((uint16_t)(SC_Ticks - _last_tick) >= SC_ICP_MAX_TICKS)
+      _elapsed_time = 0xFFFF; //the counter might have overflowed (signal too long to be measured)
+    else
+      _elapsed_time = timestamp - _last_edge; //measured duration of the previous signal
+    _last_edge = timestamp; //update
+    _last_tick = SC_Ticks; //update
+    Transition(signal);
+  }
 }
 
 // -------------------------------------------------------------------------
 
-// Create the transmitter (for when calling the default constructor)
-void SCreceiver::Create(uint8_t pin, uint8_t id){
-  //check if initialized - set only once
-  if(_initialized)
-    return;
-  
-  //check id
-  if(id == 0)
-    return;
-  if((id & 0xF) == 0)
+// Check if the line is idle for too long (end of transmission)
+void SCreceiver::CheckTimeout(void){
+  //check state
+  if((_state != SC_STATE_LISTENNING) && (_state != SC_STATE_MESSAGE_READY))
+    return;
+  
+  //check for time overflow
+  if((uint16_t)(SC_Ticks - _last_tick) >= SC_SIGNAL_MAX_TICKS){
+    _last_tick = SC_Ticks; //reset
+    Timeout();
+  }
+}
+
+// -------------------------------------------------------------------------
+
+// Check if the duration of a pulse is inside an acceptance window
+//  (<index> is one of SC_PULSE_INDEX_x)
+inline uint8_t SCreceiver::InWindow(uint16_t duration, uint8_t index){
+  return ((duration >= _window[index][0]) && (duration <= _window[index][1]));
+}
+
+// -------------------------------------------------------------------------
+
+// Get the level of a pulse of SC_CODE_PWM4
+//  (returns 0 to 3, from the time of the ZERO to the time of the ONE, or 0xFF if no level)
+inline uint8_t SCreceiver::Level(uint8_t pulse){
+  if(pulse & SC_PULSE_SHORT)
+    return 0;
+  if(pulse & SC_PULSE_MID_SHORT)
+    return 1;
+  if(pulse & SC_PULSE_MID_LONG)
+    return 2;
+  if(pulse & SC_PULSE_LONG)
+    return 3;
+  return 0xFF;
+}
+
+// -------------------------------------------------------------------------
+
+// Wait for the next frame of a burst, which follows without START (see SCtransmitter::SetBurst())
+//  NOTE: only after a valid frame or a frame to another receiver, so the
+//          pulses after a single frame are not stored as bits
+inline void SCreceiver::NextFrame(void){
+  _signal_state = SC_START | SC_FOUND;
+  _buffer_length = 0; //reset
+  _skip_bits = 0; //reset
+  _bit = SC_FEC_FIRST_BIT(_fec_type); //reset (start with msb)
+  _check = SC_CHECK_INIT(_check_type); //reset
+  _frame_corrected = 0; //reset
+  _pulse = SC_PULSE_START; //ignore the LOW of the last bit (not a bit, see Guess())
+}
+
+// -------------------------------------------------------------------------
+
+// Scale the duration of a pulse to the timing of the receiver (see SetAutoBaud())
+//  (returns the duration in the units of the engine)
+inline uint16_t SCreceiver::Normalize(uint16_t duration, uint16_t scale){
+  uint32_t value = ((uint32_t)duration * scale + 128) >> 8; //rounded
+  return ((value > 0xFFFF) ? 0xFFFF : value);
+}
+
+// -------------------------------------------------------------------------
+
+// Classify the duration of a pulse (in the units of the engine)
+//  (returns the SC_PULSE_x bits of the windows that contain the duration)
+inline uint8_t SCreceiver::Classify(uint16_t duration, uint8_t level){
+  uint8_t pulse = 0;
+  
+  if(InWindow(duration, SC_PULSE_INDEX_SHORT))
+    pulse |= SC_PULSE_SHORT;
+  if(InWindow(duration, SC_PULSE_INDEX_LONG))
+    pulse |= SC_PULSE_LONG;
+  if(InWindow(duration, (level == HIGH) ? SC_PULSE_INDEX_START_HIGH : SC_PULSE_INDEX_START_LOW))
+    pulse |= SC_PULSE_START;
+  
+  //intermediate levels
+  if(_code == SC_CODE_PWM4){
+    if(InWindow(duration, SC_PULSE_INDEX_MID_SHORT))
+      pulse |= SC_PULSE_MID_SHORT;
+    if(InWindow(duration, SC_PULSE_INDEX_MID_LONG))
+      pulse |= SC_PULSE_MID_LONG;
+  }
+  
+  //LOW of the START joined to the 1st half of a ZERO
+  if((_code == SC_CODE_MANCHESTER) && (level == LOW) && InWindow(duration, SC_PULSE_INDEX_START_HALF))
+    pulse |= SC_PULSE_START_HALF;
+  
+  return pulse;
+}
+
+// -------------------------------------------------------------------------
+
+// Manually reset buffer so one can identify when new message has arrived
+//  (returns 0 if no message, 1 otherwise)
+//  NOTE: returns the state to SC_STATE_LISTENNING
+uint8_t SCreceiver::ClearBuffer(void){
+  //remove the oldest message of the queue
+  if(_queue != NULL)
+    return PopMessage(NULL);
+  
+  //only clear if there is a message
+  if(_state != SC_STATE_MESSAGE_READY)
+    return 0;
+  
+  for(uint8_t i=0 ; i < SC_TOTAL_MESSAGE_SIZE ; i++)
+    _buffer[i] = 0;
+  _buffer_length = 0;
+  _state = SC_STATE_LISTENNING;
+  _signal_state = 0;
+  _borrowed = 0;
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Create the transmitter (for when calling the default constructor)
+void SCreceiver::Create(uint8_t pin, uint8_t id){
+  //check if initialized - set only once
+  if(_initialized)
+    return;
+  
+  //check id
+  if(id == 0)
+    return;
+  if((id & 0xF) == 0)
+    return;
+  
+  //check pin
+  if(digitalPinToPort(pin) == NOT_A_PIN)
+    return;
+  
+  _pin = pin; //set pin
+  _port = portInputRegister(digitalPinToPort(_pin)); //cache the register
+  _mask = digitalPinToBitMask(_pin); //cache the mask
+  
+  //add to the list of ports
+  _port_index = AddReceiverPort(_port);
+  if(_port_index == 0xFF)
     return;
   
   //add to the Receivers list
-  if(!AddReceiver(this))
+  if(!AddReceiver(this)){
+    RemoveReceiverPort(_port_index);
     return;
+  }
   
   _initialized = 1;
   
-  _pin = pin; //set pin
   pinMode(_pin, INPUT); //set as input
   _id = (id & 0xF); //asssign only 4 bits
   _channel = SC_DEFAULT_CHANNEL; //set channel
   _state = SC_STATE_IDLE;
-  _signal[0] = 0;
-  _signal[1] = 0;
+  _engine = SC_ENGINE_TIMER;
+  _code = SC_CODE_PWM;
+  _check_type = SC_CHECK_SUM;
+  _fec_type = SC_FEC_NONE;
+  _pulse = 0;
+  _half = SC_HALF_NONE;
+  _auto_baud = 0;
+  _scale = 256;
+  _filtered = 0;
+  _dropped = 0;
+  _corrected = 0;
+  _queue = NULL;
+  _queue_size = 0;
+  _queue_head = 0;
+  _queue_tail = 0;
+  _frame = _buffer;
+  _borrowed = 0;
+  _handler = NULL;
   _start_duration_high = SC_DEFAULT_START_DURATION_HIGH;
   _start_duration_low = SC_DEFAULT_START_DURATION_LOW;
   _duration_high = SC_DEFAULT_DURATION_HIGH;
   _duration_low = SC_DEFAULT_DURATION_LOW;
   _buffer_length = 0;
+  _skip_bits = 0;
+  UpdateWindows();
+  
+}
+
+// -------------------------------------------------------------------------
+
+// Handle a transition found by the pin change engine
+//  (<timestamp> in [us], see SC_Get_Timestamp())
+//  DO NOT call from outside the library (is public because of pin change interrupt)
+void SCreceiver::Edge(uint16_t timestamp){
+  //check engine
+  if(_engine != SC_ENGINE_PCINT)
+    return;
+  
+  //check state
+  if((_state != SC_STATE_LISTENNING) && (_state != SC_STATE_MESSAGE_READY))
+    return;
+  
+  CheckTimeout(); //the time overflow is checked only once every few ticks
   
+  uint8_t signal = SC_PIN_READ();
+  if(signal != _previous_signal){ //transition (other pins of the port can trigger the interrupt)
+    _elapsed_time = timestamp - _last_edge; //measured duration of the previous signal
+    _last_edge = timestamp; //update
+    _last_tick = SC_Ticks; //update
+    Transition(signal);
+  }
 }
 
 // -------------------------------------------------------------------------
@@ -720,6 +1996,39 @@ uint8_t SCreceiver::GetChannel(void){
 
 // -------------------------------------------------------------------------
 
+// Get the check of the frame (SC_CHECK_x)
+uint8_t SCreceiver::GetCheck(void){
+  return _check_type;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the line code of the bits (SC_CODE_x)
+uint8_t SCreceiver::GetCode(void){
+  return _code;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the correction of the frame (SC_FEC_x)
+uint8_t SCreceiver::GetCorrection(void){
+  return _fec_type;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of bits corrected in the valid frames (see SetCorrection())
+//  NOTE: the frames rejected by the check are not counted
+uint16_t SCreceiver::GetCorrectedBits(void){
+  uint8_t oldSREG = SREG;
+  cli(); //updated in the interrupt
+  uint16_t corrected = _corrected;
+  SREG = oldSREG;
+  return corrected;
+}
+
+// -------------------------------------------------------------------------
+
 // Get the high time duration for the ONE interval in [us]
 uint16_t SCreceiver::GetDurationHIGH(void){
   return _duration_high;
@@ -734,6 +2043,36 @@ uint16_t SCreceiver::GetDurationLOW(void){
 
 // -------------------------------------------------------------------------
 
+// Get the number of valid messages lost because they were not read in time
+//  (previous message not cleared or queue full)
+uint16_t SCreceiver::GetDroppedFrames(void){
+  uint8_t oldSREG = SREG;
+  cli(); //updated in the interrupt
+  uint16_t dropped = _dropped;
+  SREG = oldSREG;
+  return dropped;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the engine used to receive the signals
+uint8_t SCreceiver::GetEngine(void){
+  return _engine;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of frames to other receivers (ignored after the 1st byte)
+uint16_t SCreceiver::GetFilteredFrames(void){
+  uint8_t oldSREG = SREG;
+  cli(); //updated in the interrupt
+  uint16_t filtered = _filtered;
+  SREG = oldSREG;
+  return filtered;
+}
+
+// -------------------------------------------------------------------------
+
 // Get the ID of the receiver
 uint8_t SCreceiver::GetID(void){
   return _id;
@@ -744,11 +2083,20 @@ uint8_t SCreceiver::GetID(void){
 // Get the message
 //  (returns 0 if no message or 1 if successful)
 uint8_t SCreceiver::GetMessage(uint8_t *buffer){
+  //get the oldest message of the queue (not removed, see PopMessage())
+  if(_queue != NULL){
+    if(_queue_tail == _queue_head)
+      return 0; //empty
+    for(uint8_t i=0 ; i < _queue[_queue_tail].length ; i++)
+      buffer[i] = _queue[_queue_tail].frame[i+2]; //ignore (ID + Channel) & Length
+    return 1;
+  }
+  
   //check if message available
   if(_state != SC_STATE_MESSAGE_READY)
     return 0;
   
-  for(uint8_t i=2 ; i < (_buffer_length - 1) ; i++) //ignore (ID + Channel) & Length & CheckSum
+  for(uint8_t i=2 ; i < (_buffer[1] + 2) ; i++) //ignore (ID + Channel) & Length & Check
     buffer[i-2] = _buffer[i];
   
   return 1;
@@ -759,11 +2107,18 @@ uint8_t SCreceiver::GetMessage(uint8_t *buffer){
 // Get the length of the message
 //  (returns 0 if no message)
 uint8_t SCreceiver::GetMessageLength(void){
+  //length of the oldest message of the queue
+  if(_queue != NULL){
+    if(_queue_tail == _queue_head)
+      return 0; //empty
+    return _queue[_queue_tail].length;
+  }
+  
   //check if message available
   if(_state != SC_STATE_MESSAGE_READY)
     return 0;
   
-  return (_buffer_length - 3); //ignore (ID + Channel) & Length & CheckSum
+  return _buffer[1]; //validated length of the message
 }
 
 // -------------------------------------------------------------------------
@@ -791,11 +2146,70 @@ uint16_t SCreceiver::GetStartDurationLOW(void){
 
 // Get the state
 uint8_t SCreceiver::GetState(void){
+  //the receiver keeps listenning when there are messages in the queue
+  if((_queue != NULL) && (_state == SC_STATE_LISTENNING) && (_queue_tail != _queue_head))
+    return SC_STATE_MESSAGE_READY;
+  
   return _state;
 }
 
 // -------------------------------------------------------------------------
 
+// Get the timing of the transmitter learned from the last START (see SetAutoBaud())
+//  (returns the times of the transmitter in % of the times of the receiver)
+uint16_t SCreceiver::GetTiming(void){
+  uint16_t scale;
+  uint8_t oldSREG = SREG;
+  cli(); //changed in the interrupt
+  scale = _scale;
+  SREG = oldSREG;
+  
+  return (25600UL / scale);
+}
+
+// -------------------------------------------------------------------------
+
+// Get the message in place, without copying it
+//  (returns NULL if no message, see GetMessageLength() for the length)
+//  NOTE: the message is kept until Release() is called (the frames received
+//          meanwhile are dropped if there is no queue, see SetQueue())
+const uint8_t *SCreceiver::GetView(void){
+  //the oldest message of the queue is not changed by the interrupt
+  if(_queue != NULL){
+    if(_queue_tail == _queue_head)
+      return NULL; //empty
+    return &_queue[_queue_tail].frame[2]; //ignore (ID + Channel) & Length
+  }
+  
+  uint8_t oldSREG = SREG;
+  cli(); //a START can overwrite the message
+  if(_state != SC_STATE_MESSAGE_READY){
+    SREG = oldSREG;
+    return NULL;
+  }
+  _borrowed = 1;
+  SREG = oldSREG;
+  
+  return &_buffer[2]; //ignore (ID + Channel) & Length
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of messages in the queue
+//  (returns 0 or 1 if there is no queue)
+uint8_t SCreceiver::GetQueued(void){
+  if(_queue == NULL)
+    return ((_state == SC_STATE_MESSAGE_READY) ? 1 : 0);
+  
+  uint8_t head = _queue_head; //changed in the interrupt
+  if(head >= _queue_tail)
+    return (head - _queue_tail);
+  else
+    return (_queue_size - _queue_tail + head);
+}
+
+// -------------------------------------------------------------------------
+
 // Check if is listenning
 //  (returns 1 if listenning or there is a message, 0 otherwise)
 uint8_t SCreceiver::isListenning(void){
@@ -832,15 +2246,76 @@ int8_t SCreceiver::Listen(void){
   if((_channel & 0xF) == 0)
     return -3;
   
-  //start timer if necessary
-  if(!SC_TIMER_STARTED)
-    SC_Start_Timer();
-  
   _state = SC_STATE_LISTENNING;
   _elapsed_time = 0; //set for the 1st time
+  _last_tick = SC_Ticks; //set for the 1st time (not atomic, but only the timeout can be longer)
   _previous_signal = LOW; //set for the 1st time
   _signal_state = 0; //set for the 1st time
   _buffer_length = 0; //reset
+  _skip_bits = 0; //reset
+  _borrowed = 0; //reset
+  _scale = 256; //reset (same timing until the 1st START)
+  
+  //add to the active receivers & start timer if necessary
+  AddActiveReceiver(this);
+  if(!SC_TIMER_STARTED)
+    SC_Start_Timer();
+  
+#if SC_USE_PCINT
+  //enable the pin change interrupt
+  if(_engine == SC_ENGINE_PCINT){
+    uint8_t oldSREG = SREG;
+    cli();
+    _last_edge = SC_Get_Timestamp(); //set for the 1st time
+    SREG = oldSREG;
+    *digitalPinToPCMSK(_pin) |= _BV(digitalPinToPCMSKbit(_pin));
+    *digitalPinToPCICR(_pin) |= _BV(digitalPinToPCICRbit(_pin));
+  }
+#endif
+  
+#if SC_USE_ICP
+  //enable the input capture interrupt
+  if(_engine == SC_ENGINE_ICP){
+    SC_Start_Timer1();
+    uint8_t oldSREG = SREG;
+    cli();
+    _last_edge = TCNT1; //set for the 1st time
+    TCCR1B |= _BV(ICNC1) | _BV(ICES1); //noise canceler & rising edge (the previous signal is LOW)
+    TIFR1 = _BV(ICF1); //clear
+    TIMSK1 |= _BV(ICIE1);
+    SREG = oldSREG;
+  }
+#endif
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Get & remove the oldest message of the queue
+//  (returns 0 if no message, 1 otherwise)
+//  NOTE: <buffer> can be NULL to only remove the message
+//  NOTE: same as GetMessage() + ClearBuffer() if there is no queue
+uint8_t SCreceiver::PopMessage(uint8_t *buffer){
+  if(_queue == NULL){
+    if((buffer != NULL) && !GetMessage(buffer))
+      return 0;
+    return ClearBuffer();
+  }
+  
+  if(_queue_tail == _queue_head)
+    return 0; //empty
+  
+  if(buffer != NULL){
+    for(uint8_t i=0 ; i < _queue[_queue_tail].length ; i++)
+      buffer[i] = _queue[_queue_tail].frame[i+2]; //ignore (ID + Channel) & Length
+  }
+  
+  //free the slot (the interrupt only writes to the head)
+  uint8_t tail = _queue_tail + 1;
+  if(tail >= _queue_size)
+    tail = 0;
+  _queue_tail = tail;
   
   return 1;
 }
@@ -848,16 +2323,12 @@ int8_t SCreceiver::Listen(void){
 // -------------------------------------------------------------------------
 
 // Receive message
+//  NOTE: called only on the ticks with a transition of the pin (see SC_Timer_Tick())
 void SCreceiver::Receive(void){
   /*
       1) check if listenning
-      2) update elapsed time
-      3) check for time overflow
-      4) analyze data received (on transition)
-        4.1) check for start signal (reset state & buffer_length)
-        4.2) check for buffer overflow (when applicable)
-        4.3) store value (when applicable)
-        4.4) update signal value
+      2) get the duration of the previous signal
+      3) analyze data received (on transition, see Transition())
       
       {ID+Chn, Len,   mes,    CS} --> (message to send)
       {0x11, 0x03, 1, 2, 3, 0x06} --> {00010001, 00000011, 00000001, 00000010, 00000011, 00000110}
@@ -867,107 +2338,49 @@ void SCreceiver::Receive(void){
   if(!_initialized)
     return;
   
+  //check engine
+  if(_engine != SC_ENGINE_TIMER)
+    return;
+  
   //check state
   if((_state != SC_STATE_LISTENNING) && (_state != SC_STATE_MESSAGE_READY))
     return;
   
-  _elapsed_time += SC_TIMER_INTERVAL; //update
-  
-  //check for time overflow
-  if(_elapsed_time >= SC_SIGNAL_MAX_TIME){
-    
-    _elapsed_time = 0; //reset
-    _previous_signal = LOW; //reset
-    //check if is end of transmission
-    if(_signal_state & SC_FOUND){
-      if(abs(_signal[0] - _duration_high) <= SC_SIGNAL_DEVIATION){ // ONE
-        //check for buffer overflow
-        if(_buffer_length >= SC_TOTAL_MESSAGE_SIZE){
-          _state = SC_STATE_ERROR_OVERFLOW;
-          return;
-        }
-        //not overflow, continue
-        _buffer[_buffer_length] |= (1 << _bit); //store value (bitwise OR)
-        if(_bit <= 0){ //SHOULD ENTER HERE !
-          _buffer_length++; //new byte
-        }
-      } else if(abs(_signal[0] - _duration_low) <= SC_SIGNAL_DEVIATION){ // ZERO
-        //check for buffer overflow
-        if(_buffer_length >= SC_TOTAL_MESSAGE_SIZE){
-          _state = SC_STATE_ERROR_OVERFLOW;
-          return;
-        }
-        //not overflow, continue
-        _buffer[_buffer_length] &= ~(1 << _bit); //store value (bitwise AND + using NOT operator)
-        if(_bit <= 0){ //SHOULD ENTER HERE !
-          _buffer_length++; //new byte
-        }
-      }
-    }
-    //validate message if someting was found
-    if((_signal_state & SC_FOUND) && (_state == SC_STATE_LISTENNING))
-      ValidateMessage();
-    _signal_state = 0; //reset
+#if SC_FAST_IO
+  uint8_t signal = (ReceiverPortsValue[_port_index] & _mask) ? HIGH : LOW; //sampled in SC_Timer_Tick()
+#else
+  uint8_t signal = SC_PIN_READ();
+#endif
   
-  } else { // WAIT NEXT CYCLE TO BEGIN because call to ValidateMessage() can be too much time consuming
+  CheckTimeout(); //the time overflow is checked only once every few ticks
   
-  uint8_t signal = digitalRead(_pin);
   if(signal != _previous_signal){ //transition
-    if((_previous_signal == LOW) && (_signal_state & SC_FOUND)){ //store LOW if already found something
-      _signal[1] = _elapsed_time; //previous was LOW
-      _elapsed_time = 0; //reset for next signal
-      
-      //check wich signal was found
-      if((abs(_signal[0] - _start_duration_high) <= SC_SIGNAL_DEVIATION) && (abs(_signal[1] - _start_duration_low) <= SC_SIGNAL_DEVIATION)){ // START
-        _signal_state = SC_START | SC_FOUND;
-        _buffer_length = 0; //reset
-        _bit = 7; //reset (start with msb)
-        //set state if necessary (overwrite previous message)
-        if(_state == SC_STATE_MESSAGE_READY)
-          _state = SC_STATE_LISTENNING;
-      } else if((abs(_signal[0] - _duration_high) <= SC_SIGNAL_DEVIATION) && (abs(_signal[1] - _duration_low) <= SC_SIGNAL_DEVIATION)){ // ONE        
-        //check for buffer overflow
-        if(_buffer_length >= SC_TOTAL_MESSAGE_SIZE){
-          _state = SC_STATE_ERROR_OVERFLOW;
-          return;
-        }
-        //not overflow, continue
-        _signal_state = SC_ONE | SC_FOUND;
-        _buffer[_buffer_length] |= (1 << _bit); //store value (bitwise OR)
-        if(_bit <= 0){
-          _bit = 7; //reset
-          _buffer_length++; //new byte
-        } else {
-          _bit--; //decrease
-        }
-      } else if((abs(_signal[0] - _duration_low) <= SC_SIGNAL_DEVIATION) && (abs(_signal[1] - _duration_high) <= SC_SIGNAL_DEVIATION)){ // ZERO
-        //check for buffer overflow
-        if(_buffer_length >= SC_TOTAL_MESSAGE_SIZE){
-          _state = SC_STATE_ERROR_OVERFLOW;
-          return;
-        }
-        //not overflow, continue
-        _signal_state = SC_ZERO | SC_FOUND;
-        _buffer[_buffer_length] &= ~(1 << _bit); //store value (bitwise AND + using NOT operator)
-        if(_bit <= 0){
-          _bit = 7; //reset
-          _buffer_length++; //new byte
-        } else {
-          _bit--; //decrease
-        }
-      }
-    } else if((_previous_signal == LOW) && ((_signal_state & SC_FOUND) == 0)){ //found first signal
-      _signal_state |= SC_FOUND;
-      _elapsed_time = 0; //reset for next signal
-    } else if((_previous_signal == HIGH) && (_signal_state & SC_FOUND)){ //store HIGH if already found something
-      _signal[0] = _elapsed_time; //previous was HIGH
-      _elapsed_time = 0; //reset for next signal
-    }
-    
-    _previous_signal = signal; //update
+    _elapsed_time = SC_Ticks - _last_tick; //duration of the previous signal in ticks
+    _last_tick = SC_Ticks; //update
+    Transition(signal);
   }
-  
-  } //end of WAIT NEXT CYCLE
+}
+
+// -------------------------------------------------------------------------
+
+// Release the message got with GetView()
+//  (returns 0 if no message, 1 otherwise)
+//  NOTE: same as ClearBuffer(), but the buffer is not erased
+uint8_t SCreceiver::Release(void){
+  //remove the oldest message of the queue
+  if(_queue != NULL)
+    return PopMessage(NULL);
+  
+  uint8_t oldSREG = SREG;
+  cli(); //changed on START
+  _borrowed = 0;
+  if(_state != SC_STATE_MESSAGE_READY){
+    SREG = oldSREG;
+    return 0;
+  }
+  _state = SC_STATE_LISTENNING;
+  SREG = oldSREG;
+  return 1;
 }
 
 // -------------------------------------------------------------------------
@@ -980,6 +2393,19 @@ void SCreceiver::Reset(void){
 
 // -------------------------------------------------------------------------
 
+// Learn the timing of the transmitter from the START of each frame
+//  NOTE: the HIGH of the START can last from 1/SC_AUTO_BAUD_RANGE to
+//          SC_AUTO_BAUD_RANGE times the one of the receiver, and the
+//          pulses of the frame are scaled by the same ratio before
+//          being classified (the ratios of the times must match)
+//  NOTE: must call Listen() again after changing the mode
+void SCreceiver::SetAutoBaud(uint8_t enable){
+  Stop(); //stop the reception before changing the mode
+  _auto_baud = (enable != 0);
+}
+
+// -------------------------------------------------------------------------
+
 // Set the channel to transmit
 void SCreceiver::SetChannel(uint8_t channel){
   _channel = (channel & 0xF); //assign only 4 bits
@@ -987,20 +2413,179 @@ void SCreceiver::SetChannel(uint8_t channel){
 
 // -------------------------------------------------------------------------
 
+// Set the check of the frame (SC_CHECK_x)
+//  (returns 0 on invalid type or 1 if successful)
+//  NOTE: must call Listen() again after changing the check
+//  NOTE: must match the check of the SCtransmitter
+uint8_t SCreceiver::SetCheck(uint8_t type){
+  //check type
+  if((type != SC_CHECK_SUM) && (type != SC_CHECK_CRC8) && (type != SC_CHECK_CRC16))
+    return 0;
+  
+  Stop(); //stop the reception before changing the check
+  _check_type = type;
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the line code of the bits (SC_CODE_x)
+//  (returns 0 on invalid code or 1 if successful)
+//  NOTE: must call Listen() again after changing the code
+//  NOTE: must match the code of the SCtransmitter
+//  NOTE: the times are corrected for the levels of the code (see SetInterval())
+uint8_t SCreceiver::SetCode(uint8_t code){
+  //check code
+  if((code != SC_CODE_PWM) && (code != SC_CODE_PWM4) && (code != SC_CODE_MANCHESTER))
+    return 0;
+  
+  Stop(); //stop the reception before changing the code
+  _code = code;
+  
+  return SetInterval(_duration_high, _duration_low); //correct the times
+}
+
+// -------------------------------------------------------------------------
+
+// Set the correction of the frame (SC_FEC_x)
+//  (returns 0 on invalid type or 1 if successful)
+//  NOTE: must call Listen() again after changing the correction
+//  NOTE: must match the correction of the SCtransmitter
+//  NOTE: with SC_FEC_HAMMING, an invalid symbol of SC_CODE_PWM or
+//          SC_CODE_PWM4 still gives its bits (see Guess()), so one bit
+//          of each codeword is corrected before the check of the frame.
+//          Two bits in a row are in different codewords, so a symbol
+//          of SC_CODE_PWM4 is also corrected. An invalid pulse of
+//          SC_CODE_MANCHESTER still loses the frame (the clock is lost)
+uint8_t SCreceiver::SetCorrection(uint8_t type){
+  //check type
+  if((type != SC_FEC_NONE) && (type != SC_FEC_HAMMING))
+    return 0;
+  
+  Stop(); //stop the reception before changing the correction
+  _fec_type = type;
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the engine used to receive the signals
+//  (returns 0 on invalid engine or 1 if successful)
+//  NOTE: must call Listen() again after changing the engine
+//  NOTE: SC_ENGINE_PCINT is only available if SC_USE_PCINT is set
+//          and the pin has a pin change interrupt
+//  NOTE: SC_ENGINE_ICP is only available if SC_USE_ICP is set, for
+//          a single receiver on SC_ICP_PIN (set the engine before
+//          setting times shorter than SC_MIN_DURATION)
+uint8_t SCreceiver::SetEngine(uint8_t engine){
+  //check engine
+  if(engine == SC_ENGINE_PCINT){
+#if SC_USE_PCINT
+    if(!_initialized)
+      return 0;
+    if(digitalPinToPCICR(_pin) == NULL)
+      return 0;
+#else
+    return 0;
+#endif
+  } else if(engine == SC_ENGINE_ICP){
+#if SC_USE_ICP && defined(SC_ICP_PIN)
+    if(!_initialized)
+      return 0;
+    if(_pin != SC_ICP_PIN)
+      return 0;
+    if((SC_ICP_Receiver != NULL) && (SC_ICP_Receiver != this))
+      return 0; //already used by another receiver
+#else
+    return 0;
+#endif
+  } else if(engine != SC_ENGINE_TIMER){
+    return 0;
+  }
+  
+  Stop(); //stop the reception before changing the engine
+  _engine = engine;
+  
+#if SC_USE_ICP
+  if(_engine == SC_ENGINE_ICP){
+    SC_ICP_Receiver = this; //reserve the input capture engine
+  } else {
+    if(SC_ICP_Receiver == this)
+      SC_ICP_Receiver = NULL; //release
+    
+    //restore the default times if too short for the other engines
+    if((((uint32_t)_duration_high + _duration_low) < SC_MIN_DURATION) || (_duration_high < SC_MIN_DURATION_INTERVAL) || (_duration_low < SC_MIN_DURATION_INTERVAL)){
+      _duration_high = SC_DEFAULT_DURATION_HIGH;
+      _duration_low = SC_DEFAULT_DURATION_LOW;
+    }
+  }
+#endif
+  
+  UpdateWindows();
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the function called for each message (NULL to disable)
+//  NOTE: the function is called by SC_Dispatch(), outside the interrupt
+//  NOTE: the message is released after the function returns (do not call Release())
+void SCreceiver::SetHandler(SChandler handler){
+  _handler = handler;
+}
+
+// -------------------------------------------------------------------------
+
+// Set all the times at once, without correction (see SCreceiverT)
+void SCreceiver::SetTimes(uint16_t high_time, uint16_t low_time, uint16_t start_high_time, uint16_t start_low_time){
+  Stop(); //stop the reception before changing values
+  
+  _duration_high = high_time;
+  _duration_low = low_time;
+  _start_duration_high = start_high_time;
+  _start_duration_low = start_low_time;
+  
+  UpdateWindows();
+}
+
+// -------------------------------------------------------------------------
+
 // Set the high and low times for the ONE signal in [us]
 //  (returns 0 on invalid values or 1 if successful)
 //  NOTE: must call Listen() again after changing the values
 //  NOTE: ZERO signal has the same times but with the order inverted
+//  NOTE: with SC_CODE_PWM4, the difference of the times is at least 3 times
+//          the one of the ONE & ZERO (see SetCode())
+//  NOTE: with SC_CODE_MANCHESTER, the LOW time is half of the period of the
+//          bit and the HIGH time is corrected to the period
 //  NOTE: all values must match the correspondant values in SCtransmitter
 //  NOTE: the functions automatically corrects values if they are
 //          incompatible with library definitions
 uint8_t SCreceiver::SetInterval(uint16_t high_time, uint16_t low_time){
+  uint16_t deviation = SC_SIGNAL_DEVIATION;
+  uint16_t min_duration = SC_MIN_DURATION;
+  uint16_t min_interval = SC_MIN_DURATION_INTERVAL;
+#if SC_USE_ICP
+  if(_engine == SC_ENGINE_ICP){ //the transitions are timestamped by the hardware
+    deviation = SC_T1_SIGNAL_DEVIATION;
+    min_duration = SC_T1_MIN_DURATION;
+    min_interval = SC_T1_MIN_DURATION_INTERVAL;
+  }
+#endif
+  
+  uint16_t separation = 2 * deviation;
+  if(_code == SC_CODE_PWM4)
+    separation *= 3; //4 levels between the times (see SetCode())
+  
   //check values
-  if((high_time + low_time) < SC_MIN_DURATION)
+  if((high_time + low_time) < min_duration)
     return 0;
-  if(high_time < SC_MIN_DURATION_INTERVAL)
+  if(high_time < min_interval)
     return 0;
-  if(low_time < SC_MIN_DURATION_INTERVAL)
+  if(low_time < min_interval)
     return 0;
   
   Stop(); //stop the transmission before changing values
@@ -1016,40 +2601,76 @@ uint8_t SCreceiver::SetInterval(uint16_t high_time, uint16_t low_time){
   else
     _duration_low = low_time;
   
+  //the HIGH time is the period of the bit (see SetCode())
+  if(_code == SC_CODE_MANCHESTER){
+    if(_duration_low > (SC_SIGNAL_MAX_TIME / 2))
+      _duration_low = SC_SIGNAL_MAX_TIME / 2;
+    _duration_high = 2 * _duration_low;
+  }
+  
   //check difference
-  if(abs(_duration_high - _duration_low) < (2 * SC_SIGNAL_DEVIATION)){
+  if(abs(_duration_high - _duration_low) < separation){
     if(_duration_high >= _duration_low){
-      _duration_low = _duration_high - 2 * SC_SIGNAL_DEVIATION;
-      if(_duration_low < SC_MIN_DURATION_INTERVAL){ //check for low limit
-        _duration_low = SC_MIN_DURATION_INTERVAL;
-        _duration_high = _duration_low + 2 * SC_SIGNAL_DEVIATION;
+      if(_duration_high < (min_interval + separation)){ //check for low limit
+        _duration_low = min_interval;
+        _duration_high = _duration_low + separation;
+      } else {
+        _duration_low = _duration_high - separation;
       }
       if(_duration_high > SC_SIGNAL_MAX_TIME){ //SHOULD NEVER ENTER HERE !!! (means wrong value definitions)
         _state = SC_STATE_ERROR_DEFINITIONS;
         return 0;
       }
     } else {
-      _duration_high = _duration_low - 2 * SC_SIGNAL_DEVIATION;
-      if(_duration_high < SC_MIN_DURATION_INTERVAL){ //check for low limit
-        _duration_high = SC_MIN_DURATION_INTERVAL;
-        _duration_low = _duration_low + 2 * SC_SIGNAL_DEVIATION;
+      if(_duration_low < (min_interval + separation)){ //check for low limit
+        _duration_high = min_interval;
+        _duration_low = _duration_high + separation;
+      } else {
+        _duration_high = _duration_low - separation;
       }
-      if(_duration_low > SC_SIGNAL_MAX_TIME) //SHOULD NEVER ENTER HERE !!! (means wrong value definitions)
+      if(_duration_low > SC_SIGNAL_MAX_TIME){ //SHOULD NEVER ENTER HERE !!! (means wrong value definitions)
         _state = SC_STATE_ERROR_DEFINITIONS;
         return 0;
+      }
     }
   }
   
+  UpdateWindows();
+  
   return 1;
 }
 
 // -------------------------------------------------------------------------
 
-// Set the high and low times for the start signal in [us]
+// Set the queue of messages of the receiver
 //  (returns 0 on invalid values or 1 if successful)
-//  NOTE: must call Listen() again after changing the values
-//  NOTE: all values must match the correspondant values in SCtransmitter
-//  NOTE: the functions automatically corrects values if they are
+//  NOTE: the queue holds <number> - 1 messages (one slot is always free,
+//          so the interrupt and the program never use the same slot)
+//  NOTE: <slots> can be NULL to keep only the last message (default)
+//  NOTE: must call Listen() again after changing the queue
+uint8_t SCreceiver::SetQueue(SCmessage *slots, uint8_t number){
+  //check values
+  if((slots != NULL) && (number < 2))
+    return 0;
+  
+  Stop(); //stop the reception before changing the queue
+  
+  _queue = slots;
+  _queue_size = (slots != NULL) ? number : 0;
+  _queue_head = 0; //reset
+  _queue_tail = 0; //reset
+  _frame = (slots != NULL) ? slots[0].frame : _buffer; //the frames are received in the free slot
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Set the high and low times for the start signal in [us]
+//  (returns 0 on invalid values or 1 if successful)
+//  NOTE: must call Listen() again after changing the values
+//  NOTE: all values must match the correspondant values in SCtransmitter
+//  NOTE: the functions automatically corrects values if they are
 //          incompatible with library definitions
 uint8_t SCreceiver::SetStart(uint16_t high_time, uint16_t low_time){
   //check values
@@ -1073,6 +2694,8 @@ uint8_t SCreceiver::SetStart(uint16_t high_time, uint16_t low_time){
   else
     _start_duration_low = low_time;
   
+  UpdateWindows();
+  
   return 1;
 }
 
@@ -1081,6 +2704,393 @@ uint8_t SCreceiver::SetStart(uint16_t high_time, uint16_t low_time){
 // Stop the communication
 void SCreceiver::Stop(void){
   _state = SC_STATE_IDLE; //reset
+  RemoveActiveReceiver(this);
+  
+#if SC_USE_PCINT
+  //disable the pin change interrupt
+  if(_initialized && (_engine == SC_ENGINE_PCINT))
+    *digitalPinToPCMSK(_pin) &= ~_BV(digitalPinToPCMSKbit(_pin));
+#endif
+  
+#if SC_USE_ICP
+  //disable the input capture interrupt
+  if(_initialized && (_engine == SC_ENGINE_ICP)){
+    uint8_t oldSREG = SREG;
+    cli();
+    TIMSK1 &= ~_BV(ICIE1);
+    SREG = oldSREG;
+  }
+#endif
+}
+
+// -------------------------------------------------------------------------
+
+// Check the ID & Channel as soon as the 1st byte is received
+//  (the rest of the frame is ignored if it is to another receiver)
+//  NOTE: with a queue, the length is also received and the rest of the
+//        bits are only counted (see StoreBit()), to find the end of the
+//        frame, because the next frame of a burst follows without START
+inline void SCreceiver::Filter(void){
+  if((_bit != SC_FEC_FIRST_BIT(_fec_type)) || (_signal_state & SC_SKIP) || (_skip_bits > 0))
+    return;
+  
+  if((_buffer_length == 1) && (_frame[0] != ((_id << 4) | _channel))){
+    _filtered++;
+    if((_queue == NULL) || (_code == SC_CODE_MANCHESTER)) //no burst
+      _signal_state |= SC_SKIP; //ignore the rest of the frame
+  } else if((_buffer_length == 2) && (_frame[0] != ((_id << 4) | _channel))){
+    if(_frame[1] > SC_MESSAGE_SIZE)
+      _signal_state |= SC_SKIP; //invalid length (wait for the next START)
+    else
+      _skip_bits = (uint16_t)(_frame[1] + SC_CHECK_SIZE(_check_type)) * (SC_FEC_FIRST_BIT(_fec_type) + 1);
+  }
+}
+
+// -------------------------------------------------------------------------
+
+// Handle the end of transmission
+//  (returns 1 if a valid message was received, 0 otherwise)
+//  NOTE: the LOW of the last bit is not measured, so the bit is given by the HIGH
+uint8_t SCreceiver::Finish(void){
+  uint8_t valid = 0;
+  
+  //check if the frame was ignored
+  if((_signal_state & SC_SKIP) || (_skip_bits > 0)){
+    _signal_state = 0; //reset
+    _skip_bits = 0; //reset
+    return 0;
+  }
+  
+  //check if is end of transmission (the bits of SC_CODE_MANCHESTER are already stored)
+  if((_signal_state & SC_FOUND) && (_code != SC_CODE_MANCHESTER)){
+    if(_code == SC_CODE_PWM4){ // 2 bits
+      uint8_t value = Level(_pulse);
+      if(value == 0xFF)
+        value = Guess(0);
+      if(value != 0xFF){
+        if(!StoreBit(value >> 1) || !StoreBit(value & 0x01))
+          return 0; //buffer overflow
+      }
+    } else if(_pulse & SC_PULSE_LONG){ // ONE
+      if(!StoreBit(1))
+        return 0; //buffer overflow
+    } else if(_pulse & SC_PULSE_SHORT){ // ZERO
+      if(!StoreBit(0))
+        return 0; //buffer overflow
+    } else { // invalid (corrected later)
+      uint8_t value = Guess(0);
+      if((value != 0xFF) && !StoreBit(value))
+        return 0; //buffer overflow
+    }
+  }
+  //validate message if someting was found
+  if((_signal_state & SC_FOUND) && (_state == SC_STATE_LISTENNING) && (_buffer_length > 0))
+    valid = ValidateMessage();
+  _signal_state = 0; //reset
+  _buffer_length = 0; //reset (a signal without START must not validate the same frame again)
+  return valid;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the value of an invalid symbol of SC_CODE_PWM or SC_CODE_PWM4
+//  (returns 0xFF without correction, the value otherwise)
+//  NOTE: the bits are stored anyway, so the next bits are not shifted
+//          and the correction can fix the value (see SetCorrection())
+//  NOTE: the HIGH gives the value if it is valid, then the LOW
+//  NOTE: the HIGH of a START is not a bit
+//  NOTE: the bits of a frame to another receiver are always counted (see Filter())
+inline uint8_t SCreceiver::Guess(uint8_t low){
+  if(((_fec_type == SC_FEC_NONE) && (_skip_bits == 0)) || (_signal_state & SC_SKIP) || (_pulse & SC_PULSE_START))
+    return 0xFF;
+  
+  if(_code == SC_CODE_PWM4){
+    uint8_t value = Level(_pulse);
+    if(value == 0xFF){
+      value = Level(low);
+      value = (value == 0xFF) ? 0 : (3 - value); //the LOW is the complement of the HIGH
+    }
+    return value;
+  }
+  
+  if(_pulse & (SC_PULSE_LONG | SC_PULSE_SHORT))
+    return ((_pulse & SC_PULSE_LONG) != 0);
+  return ((low & SC_PULSE_SHORT) != 0);
+}
+
+// -------------------------------------------------------------------------
+
+// Store a bit of the frame
+//  (returns 0 on buffer overflow, 1 otherwise)
+//  NOTE: the check of the message is updated as each byte of the message
+//          is received, so ValidateMessage() does not loop over the buffer
+//  NOTE: with SC_FEC_HAMMING, the 16 bits of a byte are decoded when the
+//          last one is received (before the check)
+inline uint8_t SCreceiver::StoreBit(uint8_t value){
+  //only count the bits of a frame to another receiver (see Filter())
+  if(_skip_bits > 0){
+    _skip_bits--;
+    return 1;
+  }
+  
+  //check for buffer overflow
+  if(_buffer_length >= SC_TOTAL_MESSAGE_SIZE){
+    _state = SC_STATE_ERROR_OVERFLOW;
+    return 0;
+  }
+  
+  //not overflow, continue
+  if(_fec_type == SC_FEC_HAMMING)
+    _coded = (_coded << 1) | value; //msb first
+  else if(value)
+    _frame[_buffer_length] |= (1 << _bit); //store value (bitwise OR)
+  else
+    _frame[_buffer_length] &= ~(1 << _bit); //store value (bitwise AND + using NOT operator)
+  
+  if(_bit <= 0){
+    if(_fec_type == SC_FEC_HAMMING)
+      _frame[_buffer_length] = SC_FEC_Decode(_coded, &_frame_corrected);
+    //update the check (not with the check itself, nor with the ID & length for the sum)
+    if((_buffer_length < (_frame[1] + 2)) && ((_buffer_length >= 2) || (_check_type != SC_CHECK_SUM)))
+      _check = SC_Check_Update(_check_type, _check, _frame[_buffer_length]);
+    _bit = SC_FEC_FIRST_BIT(_fec_type); //reset
+    _buffer_length++; //new byte
+  } else {
+    _bit--; //decrease
+  }
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Store the halves of bits of a pulse of SC_CODE_MANCHESTER
+//  (returns 0 on buffer overflow, 1 otherwise)
+//  NOTE: a pulse lasts half or all the period of the bit, so it ends
+//          either in the middle of a bit or in the middle of the next one
+//  NOTE: the rest of the frame is ignored on an invalid pulse, because
+//          the clock of the bits is lost
+inline uint8_t SCreceiver::StoreHalves(uint8_t level, uint8_t pulse){
+  uint8_t halves;
+  if(pulse & SC_PULSE_SHORT){
+    halves = 1;
+  } else if(pulse & SC_PULSE_LONG){
+    halves = 2;
+  } else {
+    _signal_state |= SC_SKIP; //wait for the next START
+    return 1;
+  }
+  
+  for( ; halves > 0 ; halves--){
+    if(_half == SC_HALF_NONE){ //1st half
+      _half = level;
+    } else if(_half == level){ //no transition in the middle of the bit
+      _signal_state |= SC_SKIP; //wait for the next START
+      return 1;
+    } else { //ONE is HIGH + LOW, ZERO is LOW + HIGH
+      if(!StoreBit(_half == HIGH))
+        return 0; //buffer overflow
+      _half = SC_HALF_NONE;
+    }
+  }
+  
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Handle the time overflow (end of transmission)
+//  NOTE: the frame usually ends on its last bit (see Transition()), so
+//          this only handles the frames with an invalid length
+void SCreceiver::Timeout(void){
+  _elapsed_time = 0; //reset
+  _previous_signal = LOW; //reset
+  Finish();
+}
+
+// -------------------------------------------------------------------------
+
+// Analyze the data received on a transition
+//  (<_elapsed_time> is the duration of the previous signal, in the units of the engine)
+void SCreceiver::Transition(uint8_t signal){
+  /*
+      1) check for start signal (reset state & buffer_length)
+      2) check for buffer overflow (when applicable)
+      3) store value (when applicable)
+      4) update signal value
+  */
+  
+  if((_previous_signal == LOW) && (_signal_state & SC_FOUND)){ //classify LOW if already found something
+    uint8_t pulse;
+    uint16_t duration = _elapsed_time;
+    uint16_t scale = _scale;
+    if(_auto_baud){
+      //the HIGH of a START gives the timing of the frame
+      if(_pulse & SC_PULSE_START)
+        scale = ((uint32_t)_start_reference << 8) / _start_high;
+      duration = Normalize(duration, scale);
+    }
+    if(_signal_state & SC_SKIP){ //frame to another receiver (only the START matters)
+      pulse = InWindow(duration, SC_PULSE_INDEX_START_LOW) ? SC_PULSE_START : 0;
+      if((_code == SC_CODE_MANCHESTER) && InWindow(duration, SC_PULSE_INDEX_START_HALF))
+        pulse |= SC_PULSE_START_HALF;
+    } else {
+      pulse = Classify(duration, LOW); //previous was LOW
+    }
+    _elapsed_time = 0; //reset for next signal
+    
+    //check wich signal was found
+    if((_pulse & SC_PULSE_START) && (pulse & (SC_PULSE_START | SC_PULSE_START_HALF))){ // START
+      if((_state == SC_STATE_MESSAGE_READY) && _borrowed){
+        //keep the message read in place (ignore the frame)
+        _signal_state = SC_START | SC_FOUND | SC_SKIP;
+        _dropped++;
+      } else {
+        _signal_state = SC_START | SC_FOUND;
+        _scale = scale; //timing of the frame
+        _buffer_length = 0; //reset
+        _skip_bits = 0; //reset
+        _bit = SC_FEC_FIRST_BIT(_fec_type); //reset (start with msb)
+        _check = SC_CHECK_INIT(_check_type); //reset
+        _frame_corrected = 0; //reset
+        _half = (pulse & SC_PULSE_START) ? SC_HALF_NONE : LOW; //the LOW can include the 1st half of a ZERO
+        //set state if necessary (overwrite previous message)
+        if(_state == SC_STATE_MESSAGE_READY){
+          _state = SC_STATE_LISTENNING;
+          _dropped++;
+        }
+      }
+    } else if(_code == SC_CODE_MANCHESTER){ // 1 or 2 halves of bits
+      if(!StoreHalves(LOW, pulse))
+        return; //buffer overflow
+    } else if(_code == SC_CODE_PWM4){ // 2 bits (the LOW is the complement of the HIGH)
+      uint8_t value = Level(_pulse);
+      if((value == 0xFF) || (Level(pulse) != (3 - value)))
+        value = Guess(pulse); //invalid symbol (corrected later)
+      if(value != 0xFF){
+        if(!StoreBit(value >> 1) || !StoreBit(value & 0x01))
+          return; //buffer overflow
+        _signal_state = (value & 0x01) | SC_FOUND;
+      }
+    } else if((_pulse & SC_PULSE_LONG) && (pulse & SC_PULSE_SHORT)){ // ONE
+      if(!StoreBit(1))
+        return; //buffer overflow
+      _signal_state = SC_ONE | SC_FOUND;
+    } else if((_pulse & SC_PULSE_SHORT) && (pulse & SC_PULSE_LONG)){ // ZERO
+      if(!StoreBit(0))
+        return; //buffer overflow
+      _signal_state = SC_ZERO | SC_FOUND;
+    } else { // invalid symbol (corrected later)
+      uint8_t value = Guess(pulse);
+      if(value != 0xFF){
+        if(!StoreBit(value))
+          return; //buffer overflow
+        _signal_state = value | SC_FOUND;
+      }
+    }
+    
+    Filter();
+  } else if((_previous_signal == LOW) && ((_signal_state & SC_FOUND) == 0)){ //found first signal
+    _signal_state |= SC_FOUND | SC_SKIP; //wait for the START (the bits are only stored after it)
+    _elapsed_time = 0; //reset for next signal
+  } else if((_previous_signal == HIGH) && (_signal_state & SC_FOUND)){ //classify HIGH if already found something
+    uint16_t duration = _elapsed_time;
+    if(_auto_baud)
+      duration = Normalize(duration, _scale);
+    if(_signal_state & SC_SKIP){ //frame to another receiver (only the START matters)
+      _pulse = InWindow(duration, SC_PULSE_INDEX_START_HIGH) ? SC_PULSE_START : 0;
+    } else {
+      _pulse = Classify(duration, HIGH); //previous was HIGH
+    }
+    
+    //the START can have another timing (see SetAutoBaud())
+    if(_auto_baud){
+      _pulse &= ~SC_PULSE_START;
+      if(InWindow(_elapsed_time, SC_PULSE_INDEX_START_RANGE)){
+        _pulse |= SC_PULSE_START;
+        _start_high = _elapsed_time;
+      }
+    }
+    
+    if((_signal_state & SC_SKIP) == 0){
+      //check for the last bit of the frame (ID + length + message + check), so the
+      //  message is ready without waiting for the time overflow
+      if(_code == SC_CODE_MANCHESTER){ // 1 or 2 halves of bits
+        if(!StoreHalves(HIGH, _pulse))
+          return; //buffer overflow
+        Filter();
+        
+        //the 2nd half of a ONE is LOW, like the idle line (not measured)
+        if(((_signal_state & SC_SKIP) == 0) && (_buffer_length >= 2)){
+          uint8_t total = _frame[1] + 2 + SC_CHECK_SIZE(_check_type);
+          if((_bit == 0) && (_half == HIGH) && (_buffer_length == (total - 1))){ //last bit is ONE
+            if(!StoreBit(1))
+              return; //buffer overflow
+            Finish();
+          } else if((_bit == SC_FEC_FIRST_BIT(_fec_type)) && (_buffer_length == total)){ //last bit is ZERO
+            Finish();
+          }
+        }
+      } else if(_skip_bits > 0){ //frame to another receiver (see Filter())
+        if(_skip_bits == ((_code == SC_CODE_PWM4) ? 2 : 1)) //last symbol
+          NextFrame();
+      } else if((_bit == ((_code == SC_CODE_PWM4) ? 1 : 0)) && (_buffer_length >= 2) && (_buffer_length == (_frame[1] + 1 + SC_CHECK_SIZE(_check_type)))){
+        if(Finish() && (_queue != NULL))
+          NextFrame();
+      }
+    }
+    _elapsed_time = 0; //reset for next signal
+  }
+  
+  _previous_signal = signal; //update
+}
+
+// -------------------------------------------------------------------------
+
+// Update the acceptance windows of the pulses
+//  (called when the durations or the engine change)
+void SCreceiver::UpdateWindows(void){
+  int16_t step = ((int16_t)_duration_high - (int16_t)_duration_low) / 3; //between the levels of SC_CODE_PWM4
+  uint16_t times[6];
+  times[SC_PULSE_INDEX_SHORT] = _duration_low;
+  times[SC_PULSE_INDEX_LONG] = _duration_high;
+  times[SC_PULSE_INDEX_START_HIGH] = _start_duration_high;
+  times[SC_PULSE_INDEX_START_LOW] = _start_duration_low;
+  times[SC_PULSE_INDEX_MID_SHORT] = _duration_low + step;
+  times[SC_PULSE_INDEX_MID_LONG] = _duration_high - step;
+  
+  for(uint8_t i=0 ; i < 6 ; i++){
+    if(_engine == SC_ENGINE_TIMER){ //in ticks
+      _window[i][0] = SC_WINDOW_MIN_TICKS(times[i]);
+      _window[i][1] = SC_WINDOW_MAX_TICKS(times[i]);
+#if SC_USE_ICP
+    } else if(_engine == SC_ENGINE_ICP){ //in counts of Timer 1
+      uint32_t counts_min = (times[i] > SC_T1_SIGNAL_DEVIATION) ? SC_US_TO_COUNTS(times[i] - SC_T1_SIGNAL_DEVIATION) : 0;
+      uint32_t counts_max = SC_US_TO_COUNTS((uint32_t)times[i] + SC_T1_SIGNAL_DEVIATION);
+      _window[i][0] = (counts_min > 0xFFFF) ? 0xFFFF : counts_min;
+      _window[i][1] = (counts_max > 0xFFFF) ? 0xFFFF : counts_max;
+#endif
+    } else { //in [us]
+      _window[i][0] = (times[i] > SC_SIGNAL_DEVIATION) ? (times[i] - SC_SIGNAL_DEVIATION) : 0;
+      _window[i][1] = ((uint32_t)times[i] + SC_SIGNAL_DEVIATION > 0xFFFF) ? 0xFFFF : (times[i] + SC_SIGNAL_DEVIATION);
+    }
+  }
+  
+  //LOW of the START joined to the 1st half of a ZERO of SC_CODE_MANCHESTER (deviation of both, after the START alone)
+  uint32_t half_min = (uint32_t)_window[SC_PULSE_INDEX_START_LOW][0] + _window[SC_PULSE_INDEX_SHORT][0];
+  uint32_t half_max = (uint32_t)_window[SC_PULSE_INDEX_START_LOW][1] + _window[SC_PULSE_INDEX_SHORT][1];
+  if(half_min <= _window[SC_PULSE_INDEX_START_LOW][1])
+    half_min = (uint32_t)_window[SC_PULSE_INDEX_START_LOW][1] + 1;
+  _window[SC_PULSE_INDEX_START_HALF][0] = (half_min > 0xFFFF) ? 0xFFFF : half_min;
+  _window[SC_PULSE_INDEX_START_HALF][1] = (half_max > 0xFFFF) ? 0xFFFF : half_max;
+  
+  //HIGH of the START with auto baud (see SetAutoBaud())
+  uint32_t range_max = (uint32_t)_window[SC_PULSE_INDEX_START_HIGH][1] * SC_AUTO_BAUD_RANGE;
+  _window[SC_PULSE_INDEX_START_RANGE][0] = _window[SC_PULSE_INDEX_START_HIGH][0] / SC_AUTO_BAUD_RANGE;
+  if(_window[SC_PULSE_INDEX_START_RANGE][0] == 0)
+    _window[SC_PULSE_INDEX_START_RANGE][0] = 1; //the duration divides the timing of the frame
+  _window[SC_PULSE_INDEX_START_RANGE][1] = (range_max > 0xFFFF) ? 0xFFFF : range_max;
+  _start_reference = ((uint32_t)_window[SC_PULSE_INDEX_START_HIGH][0] + _window[SC_PULSE_INDEX_START_HIGH][1]) / 2;
 }
 
 // -------------------------------------------------------------------------
@@ -1099,15 +3109,32 @@ uint8_t SCreceiver::ValidateMessage(void){
   
   _state = SC_STATE_VALIDATING;
   
-  if(((_buffer[0] & 0xF0) >> 4) == _id){ //check ID
-    if((_buffer[0] & 0x0F) == _channel){ //check Channel
-      if(_buffer[1] == _buffer_length - 3){ //check length (subtract ID+Channel & Length & CheckSum)
-        //create temporary buffer to calculate the checksum
-        uint8_t temp[_buffer[1]];
-        //store temporary data
-        for(uint8_t i=2 ; i < (_buffer_length - 1) ; i++) //ignore (ID + Channel) & Length & CheckSum
-          temp[i-2] = _buffer[i];
-        if(SC_CheckSum(temp, _buffer[1]) == _buffer[_buffer_length - 1]){ //check CheckSum
+  if(((_frame[0] & 0xF0) >> 4) == _id){ //check ID
+    if((_frame[0] & 0x0F) == _channel){ //check Channel
+      if(_frame[1] == _buffer_length - 2 - SC_CHECK_SIZE(_check_type)){ //check length (subtract ID+Channel & Length & Check)
+        uint16_t check = _frame[_buffer_length - 1];
+        if(_check_type == SC_CHECK_CRC16)
+          check |= (_frame[_buffer_length - 2] << 8); //msb first
+        if(_check_type != SC_CHECK_CRC16)
+          _check &= 0xFF; //8 bits
+        if(_check == check){ //check the message (updated in StoreBit())
+          _corrected += _frame_corrected;
+          //keep the message in the queue (already received in the slot, keep listenning)
+          if(_queue != NULL){
+            uint8_t head = _queue_head + 1;
+            if(head >= _queue_size)
+              head = 0;
+            if(head == _queue_tail){ //full (the slot is used by the next frame)
+              _dropped++;
+            } else {
+              _queue[_queue_head].length = _frame[1];
+              _queue_head = head;
+              _frame = _queue[head].frame; //next frame
+            }
+            _state = SC_STATE_LISTENNING;
+            return 1;
+          }
+          
           //store the message as it is >> see GetMessage() for reference
           _state = SC_STATE_MESSAGE_READY;
           return 1;
@@ -1121,6 +3148,580 @@ uint8_t SCreceiver::ValidateMessage(void){
 }
 
 
+//---------------------------------------------------------------------------------------------------------------------
+
+// *************************************************************************
+// *************************** SC Fragmenter *******************************
+// *************************************************************************
+
+// Constructor
+SCfragmenter::SCfragmenter(SCtransmitter *transmitter){
+  _transmitter = transmitter;
+  _sending = 0;
+  _sequence = 0;
+  _fragments = 0;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of fragments sent
+uint16_t SCfragmenter::GetFragments(void){
+  return _fragments;
+}
+
+// -------------------------------------------------------------------------
+
+// Check if is sending
+//  (returns 1 while there are fragments to send, 0 otherwise)
+uint8_t SCfragmenter::isSending(void){
+  return _sending;
+}
+
+// -------------------------------------------------------------------------
+
+// Send the message with given length in fragments
+//  (returns 1 on start of transmission, 0 if still sending the previous message)
+//  NOTE: the fragments are sent by Update(), so <data> must not change until
+//          isSending() returns 0
+uint8_t SCfragmenter::Send(const uint8_t *data, uint16_t length){
+  if(_sending)
+    return 0;
+  
+  _data = data;
+  _length = length;
+  _offset = 0; //reset
+  _sending = 1;
+  
+  Update(); //send the first fragments
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Send the next fragments when the transmitter is ready
+//  (returns 1 while there are fragments to send, 0 otherwise)
+//  NOTE: the transmission is aborted if the transmitter is not valid (see SCtransmitter::Send())
+//  NOTE: the data is copied only in the frame, after the control byte (see SCtransmitter::SendFragment())
+uint8_t SCfragmenter::Update(void){
+  while(_sending && _transmitter->isReady()){
+    uint16_t left = _length - _offset;
+    uint8_t size = (left > SC_FRAGMENT_SIZE) ? SC_FRAGMENT_SIZE : left;
+    
+    //the fragment: [control] [data]
+    uint8_t control = _sequence & SC_FRAGMENT_SEQUENCE;
+    if(_offset == 0)
+      control |= SC_FRAGMENT_FIRST;
+    if(size == left)
+      control |= SC_FRAGMENT_LAST;
+    
+    int8_t res = _transmitter->SendFragment(control, _data + _offset, size);
+    if(res == 0) //queue full
+      break;
+    if(res < 0){ //invalid values
+      _sending = 0;
+      break;
+    }
+    
+    _offset += size;
+    _sequence++;
+    _fragments++;
+    if(control & SC_FRAGMENT_LAST)
+      _sending = 0;
+  }
+  
+  return _sending;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// *************************************************************************
+// ************************** SC Reassembler *******************************
+// *************************************************************************
+
+// Constructor (in a buffer)
+SCreassembler::SCreassembler(SCreceiver *receiver, uint8_t *buffer, uint16_t size){
+  _receiver = receiver;
+  _buffer = buffer;
+  _size = size;
+  _sink = NULL;
+  _receiving = 0;
+  _sequence = 0xFF; //no fragment yet
+  _length = 0;
+  _lost = 0;
+  _dropped = 0;
+  _elapsed = 0;
+  _throughput = 0;
+}
+
+//---------------
+
+// Constructor (in a sink)
+SCreassembler::SCreassembler(SCreceiver *receiver, SCsink sink){
+  _receiver = receiver;
+  _buffer = NULL;
+  _size = 0xFFFF; //no limit
+  _sink = sink;
+  _receiving = 0;
+  _sequence = 0xFF; //no fragment yet
+  _length = 0;
+  _lost = 0;
+  _dropped = 0;
+  _elapsed = 0;
+  _throughput = 0;
+}
+
+// -------------------------------------------------------------------------
+
+// Drop the message being received (wait for the next first fragment)
+void SCreassembler::Drop(void){
+  if(_receiving)
+    _dropped++;
+  _receiving = 0;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of messages lost (fragments lost or buffer too small)
+uint16_t SCreassembler::GetDroppedMessages(void){
+  return _dropped;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the length of the last message
+uint16_t SCreassembler::GetLength(void){
+  return _length;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of fragments lost (missing sequence numbers)
+uint16_t SCreassembler::GetLostFragments(void){
+  return _lost;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the throughput of the last message in [bytes/s]
+//  (measured from the first to the last fragment, so the data of the first
+//    fragment is not considered; 0 if the message has only one fragment)
+uint32_t SCreassembler::GetThroughput(void){
+  return _throughput;
+}
+
+// -------------------------------------------------------------------------
+
+// Reassemble the fragments received
+//  (returns 1 when a message is complete, 0 otherwise)
+//  NOTE: with a buffer, the message must be read before calling Update() again
+//  NOTE: the time of the message is added on each call, so Update() must be
+//          called at least every 65536 ticks (see SC_Get_Ticks())
+uint8_t SCreassembler::Update(void){
+  const uint8_t *fragment;
+  
+  //time of the message in ticks (millis() is stopped with SC_TIMER 0)
+  uint16_t now = SC_Get_Ticks();
+  if(_receiving)
+    _elapsed += (uint16_t)(now - _last_tick);
+  _last_tick = now;
+  
+  while((fragment = _receiver->GetView()) != NULL){
+    uint8_t size = _receiver->GetMessageLength();
+    if(size == 0){ //not a fragment
+      _receiver->Release();
+      continue;
+    }
+    uint8_t control = fragment[0];
+    uint8_t sequence = control & SC_FRAGMENT_SEQUENCE;
+    size--; //data only
+    
+    //check the sequence (it continues across the messages, so the fragments
+    //  lost before a first fragment are counted too)
+    if(_sequence != 0xFF){
+      if(sequence == ((_sequence - 1) & SC_FRAGMENT_SEQUENCE)){ //duplicated
+        _receiver->Release();
+        continue;
+      }
+      if(sequence != _sequence)
+        _lost += (sequence - _sequence) & SC_FRAGMENT_SEQUENCE;
+    }
+    if(control & SC_FRAGMENT_FIRST){
+      Drop(); //previous message incomplete
+      _receiving = 1;
+      _length = 0; //reset
+      _elapsed = 0; //reset
+    } else if(sequence != _sequence){
+      Drop();
+    }
+    _sequence = (sequence + 1) & SC_FRAGMENT_SEQUENCE;
+    
+    //store the data
+    if(_receiving){
+      if((uint32_t)_length + size > _size){ //buffer too small
+        Drop();
+      } else {
+        if(_sink != NULL)
+          _sink(fragment + 1, size, _length);
+        else
+          for(uint8_t i=0 ; i < size ; i++)
+            _buffer[_length + i] = fragment[i+1];
+        _length += size;
+      }
+    }
+    _receiver->Release();
+    
+    //check for end of message
+    if(_receiving && (control & SC_FRAGMENT_LAST)){
+      _receiving = 0;
+      uint16_t first = (_length > SC_FRAGMENT_SIZE) ? SC_FRAGMENT_SIZE : _length;
+      _throughput = (_elapsed > 0) ? ((uint32_t)(_length - first) * (1000000UL / SC_TIMER_INTERVAL) / _elapsed) : 0;
+      return 1;
+    }
+  }
+  
+  return 0;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// *************************************************************************
+// *************************** SC Negotiator *******************************
+// *************************************************************************
+
+// Get the byte of a test frame (see SC_LINK_TEST)
+static inline uint8_t SC_Link_Pattern(uint8_t sequence, uint8_t index){
+  return ((sequence * 37) ^ (index * 11) ^ 0x55); //mix of ONEs and ZEROs
+}
+
+// -------------------------------------------------------------------------
+
+// Constructor
+SCnegotiator::SCnegotiator(SCtransmitter *transmitter, SCreceiver *receiver){
+  _transmitter = transmitter;
+  _receiver = receiver;
+  _state = SC_LINK_STATE_IDLE;
+  _step = 0;
+  _steps = 0;
+  _selected = -1;
+  _elapsed = 0;
+}
+
+// -------------------------------------------------------------------------
+
+// Send a short message to the other side (an answer or SC_LINK_CONFIRM)
+void SCnegotiator::Answer(uint8_t type, uint8_t value){
+  uint8_t message[3] = { type, _step, value };
+  _transmitter->Send(message, 3);
+}
+
+// -------------------------------------------------------------------------
+
+// Get the HIGH time of the timing of <step> in [us]
+//  (returns 0 if not probed)
+uint16_t SCnegotiator::GetDurationHIGH(uint8_t step){
+  return ((step < _steps) ? _high[step] : 0);
+}
+
+// -------------------------------------------------------------------------
+
+// Get the LOW time of the timing of <step> in [us]
+//  (returns 0 if not probed)
+uint16_t SCnegotiator::GetDurationLOW(uint8_t step){
+  return ((step < _steps) ? _low[step] : 0);
+}
+
+// -------------------------------------------------------------------------
+
+// Get the frame error rate of the timing of <step> in [%]
+//  (returns 100 if not probed)
+uint8_t SCnegotiator::GetErrorRate(uint8_t step){
+  if(step >= _steps)
+    return 100;
+  return ((SC_LINK_FRAMES - _received[step]) * 100 / SC_LINK_FRAMES);
+}
+
+// -------------------------------------------------------------------------
+
+// Get the goodput of the timing of <step> in [bytes/s]
+//  (the bytes of the test frames received over the time to send them; 0 if not probed)
+uint16_t SCnegotiator::GetGoodput(uint8_t step){
+  return ((step < _steps) ? _goodput[step] : 0);
+}
+
+// -------------------------------------------------------------------------
+
+// Get the selected timing
+//  (returns the step of the timing, or -1 if no timing met the target
+//    or if the other side did not keep it)
+//  NOTE: the times are already set in the transmitter (see GetDurationHIGH()),
+//          so they can be stored to skip the negotiation next time
+int8_t SCnegotiator::GetSelected(void){
+  return _selected;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the state of the negotiation (SC_LINK_STATE_x)
+uint8_t SCnegotiator::GetState(void){
+  return _state;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of timings probed
+uint8_t SCnegotiator::GetSteps(void){
+  return _steps;
+}
+
+// -------------------------------------------------------------------------
+
+// Check if is negotiating (or receiving the test frames)
+uint8_t SCnegotiator::isNegotiating(void){
+  return (_state != SC_LINK_STATE_IDLE);
+}
+
+// -------------------------------------------------------------------------
+
+// Probe the timing of <step> (SC_LINK_STEP % of the previous one)
+//  NOTE: the negotiation ends if the timing cannot be faster
+void SCnegotiator::Probe(uint8_t step){
+  uint16_t high = _base_high;
+  uint16_t low = _base_low;
+  if(step > 0){
+    high = (uint32_t)_high[step - 1] * SC_LINK_STEP / 100;
+    low = (uint32_t)_low[step - 1] * SC_LINK_STEP / 100;
+  }
+  
+  //the times are corrected by the transmitter (see SCtransmitter::SetInterval())
+  if((step >= SC_LINK_STEPS) || !_transmitter->SetInterval(high, low)){
+    Select();
+    return;
+  }
+  high = _transmitter->GetDurationHIGH();
+  low = _transmitter->GetDurationLOW();
+  if((step > 0) && (((uint32_t)high + low) >= ((uint32_t)_high[step - 1] + _low[step - 1]))){
+    Select();
+    return;
+  }
+  
+  _step = step;
+  _steps = step + 1;
+  _high[step] = high;
+  _low[step] = low;
+  _received[step] = 0;
+  _goodput[step] = 0;
+  
+  SendTimes(SC_LINK_SETUP, step);
+  _state = SC_LINK_STATE_SETUP;
+  _time = SC_Get_Ticks();
+}
+
+// -------------------------------------------------------------------------
+
+// Select the fastest timing that met the target (the other side keeps it too)
+//  NOTE: the other side changes the times on SC_LINK_SELECT, but keeps them
+//          only if SC_LINK_CONFIRM is received with the new times (see Update())
+void SCnegotiator::Select(void){
+  _transmitter->SetInterval(_base_high, _base_low); //until the other side answers
+  
+  //check for a timing faster than the current one
+  if(_selected <= 0){
+    _state = SC_LINK_STATE_IDLE;
+    return;
+  }
+  
+  _step = _selected;
+  SendTimes(SC_LINK_SELECT, _step);
+  _state = SC_LINK_STATE_SELECT;
+  _time = SC_Get_Ticks();
+}
+
+// -------------------------------------------------------------------------
+
+// Send the times of <step> to the other side (with the times before the negotiation)
+void SCnegotiator::SendTimes(uint8_t type, uint8_t step){
+  uint8_t message[6];
+  message[0] = type;
+  message[1] = step;
+  message[2] = (_high[step] >> 8); //msb first
+  message[3] = (_high[step] & 0xFF);
+  message[4] = (_low[step] >> 8);
+  message[5] = (_low[step] & 0xFF);
+  
+  _transmitter->SetInterval(_base_high, _base_low);
+  _transmitter->Send(message, 6);
+}
+
+// -------------------------------------------------------------------------
+
+// Start the negotiation from the current times of the transmitter
+//  (returns 0 if already negotiating, 1 otherwise)
+//  NOTE: each timing is tested with SC_LINK_FRAMES frames, and the negotiation
+//          ends on the first one with a frame error rate above <target> [%]
+//  NOTE: the other side must call Update() to answer
+uint8_t SCnegotiator::Start(uint8_t target){
+  if(_state != SC_LINK_STATE_IDLE)
+    return 0;
+  
+  _target = target;
+  _selected = -1; //reset
+  _steps = 0; //reset
+  _base_high = _transmitter->GetDurationHIGH();
+  _base_low = _transmitter->GetDurationLOW();
+  
+  Probe(0); //the current times
+  return 1;
+}
+
+// -------------------------------------------------------------------------
+
+// Handle the messages of the negotiation
+//  (returns 1 while negotiating or receiving the test frames, 0 otherwise)
+//  NOTE: when not negotiating, answers to the negotiation of the other side
+uint8_t SCnegotiator::Update(void){
+  uint8_t message[SC_MESSAGE_SIZE];
+  uint8_t length = 0;
+  uint16_t timeout = SC_US_TO_TICKS(SC_LINK_TIMEOUT * 1000UL);
+  
+  //add the ticks since the last call (the counter of ticks overflows, see SC_Get_Ticks())
+  uint16_t now = SC_Get_Ticks();
+  if(_state == SC_LINK_STATE_SENDING)
+    _elapsed += (uint16_t)(now - _last_tick);
+  _last_tick = now;
+  
+  //copy the message (the times of the receiver can change below)
+  const uint8_t *view = _receiver->GetView();
+  if(view != NULL){
+    length = _receiver->GetMessageLength();
+    for(uint8_t i=0 ; i < length ; i++)
+      message[i] = view[i];
+    _receiver->Release();
+  }
+  
+  if(_state == SC_LINK_STATE_IDLE){ //answer to the other side
+    if((length == 6) && ((message[0] == SC_LINK_SETUP) || (message[0] == SC_LINK_SELECT))){
+      _step = message[1];
+      Answer(SC_LINK_READY, 0);
+      _base_high = _receiver->GetDurationHIGH();
+      _base_low = _receiver->GetDurationLOW();
+      _count = 0; //reset
+      _time = SC_Get_Ticks();
+      if(message[0] == SC_LINK_SETUP) //test frames with the new times
+        _state = SC_LINK_STATE_TESTING;
+      else //SC_LINK_CONFIRM with the new times
+        _state = SC_LINK_STATE_CHECKING;
+      _receiver->SetInterval((message[2] << 8) | message[3], (message[4] << 8) | message[5]);
+      _receiver->Listen();
+    } else if((length == 3) && (message[0] == SC_LINK_CONFIRM)){ //the answer was lost (already kept)
+      _step = message[1];
+      Answer(SC_LINK_READY, 0);
+    }
+  } else if(_state == SC_LINK_STATE_CHECKING){ //keep the selected times if they work
+    if((length == 3) && (message[0] == SC_LINK_CONFIRM) && (message[1] == _step)){
+      Answer(SC_LINK_READY, 0);
+      _state = SC_LINK_STATE_IDLE;
+    } else if((uint16_t)(SC_Get_Ticks() - _time) >= timeout){ //back to the times of the negotiation
+      _receiver->SetInterval(_base_high, _base_low);
+      _receiver->Listen();
+      _state = SC_LINK_STATE_IDLE;
+    }
+  } else if(_state == SC_LINK_STATE_TESTING){ //count the valid test frames
+    uint8_t last = 0;
+    if((length == SC_MESSAGE_SIZE) && (message[0] == SC_LINK_TEST) && (message[1] == _step)){
+      uint8_t valid = 1;
+      for(uint8_t i=3 ; i < SC_MESSAGE_SIZE ; i++){
+        if(message[i] != SC_Link_Pattern(message[2], i))
+          valid = 0;
+      }
+      _count += valid;
+      _time = SC_Get_Ticks(); //wait for the next frame
+      last = (message[2] == (SC_LINK_FRAMES - 1));
+    }
+    
+    //back to the times of the negotiation after the last frame (or if the frames stop)
+    if(last || ((uint16_t)(SC_Get_Ticks() - _time) >= timeout)){
+      _receiver->SetInterval(_base_high, _base_low);
+      _receiver->Listen();
+      Answer(SC_LINK_RESULT, _count);
+      _state = SC_LINK_STATE_IDLE;
+    }
+  } else if(_state == SC_LINK_STATE_SETUP){ //the other side changed the times
+    if((length == 3) && (message[0] == SC_LINK_READY) && (message[1] == _step)){
+      _transmitter->SetInterval(_high[_step], _low[_step]);
+      _count = 0; //reset
+      _elapsed = 0; //reset
+      _state = SC_LINK_STATE_SENDING;
+    } else if((uint16_t)(SC_Get_Ticks() - _time) >= timeout){
+      Select();
+    }
+  } else if(_state == SC_LINK_STATE_SELECT){ //the other side changed the times
+    if((length == 3) && (message[0] == SC_LINK_READY) && (message[1] == _step)){
+      _transmitter->SetInterval(_high[_step], _low[_step]);
+      Answer(SC_LINK_CONFIRM, 0);
+      _count = 1;
+      _time = SC_Get_Ticks();
+      _state = SC_LINK_STATE_CONFIRM;
+    } else if((uint16_t)(SC_Get_Ticks() - _time) >= timeout){
+      _selected = -1; //keep the times of the negotiation (the other side goes back too)
+      _state = SC_LINK_STATE_IDLE;
+    }
+  } else if(_state == SC_LINK_STATE_CONFIRM){ //the other side kept the times
+    if((length == 3) && (message[0] == SC_LINK_READY) && (message[1] == _step)){
+      _state = SC_LINK_STATE_IDLE;
+    } else if((uint16_t)(SC_Get_Ticks() - _time) >= (timeout / (SC_LINK_TRIES + 1))){
+      if(_count < SC_LINK_TRIES){ //again
+        Answer(SC_LINK_CONFIRM, 0);
+        _count++;
+        _time = SC_Get_Ticks();
+      } else { //the other side went back to the times of the negotiation
+        _transmitter->SetInterval(_base_high, _base_low);
+        _selected = -1;
+        _state = SC_LINK_STATE_IDLE;
+      }
+    }
+  } else { //SC_LINK_STATE_SENDING or SC_LINK_STATE_RESULT
+    if((length == 3) && (message[0] == SC_LINK_RESULT) && (message[1] == _step)){
+      _received[_step] = message[2];
+      if(_elapsed > 0)
+        _goodput[_step] = (uint32_t)_received[_step] * SC_MESSAGE_SIZE * (1000000UL / SC_TIMER_INTERVAL) / _elapsed;
+      
+      //try a faster timing if the target was met
+      if(GetErrorRate(_step) <= _target){
+        _selected = _step;
+        Probe(_step + 1);
+      } else {
+        Select();
+      }
+    } else if(_state == SC_LINK_STATE_SENDING){
+      //send the test frames
+      while((_count < SC_LINK_FRAMES) && _transmitter->isReady()){
+        message[0] = SC_LINK_TEST;
+        message[1] = _step;
+        message[2] = _count;
+        for(uint8_t i=3 ; i < SC_MESSAGE_SIZE ; i++)
+          message[i] = SC_Link_Pattern(_count, i);
+        if(_transmitter->Send(message, SC_MESSAGE_SIZE) <= 0)
+          break;
+        _count++;
+      }
+      
+      //wait for the result with the times of the negotiation
+      if((_count >= SC_LINK_FRAMES) && !_transmitter->isSending()){
+        _transmitter->SetInterval(_base_high, _base_low);
+        _time = SC_Get_Ticks();
+        _state = SC_LINK_STATE_RESULT;
+      }
+    } else if((uint16_t)(SC_Get_Ticks() - _time) >= timeout){
+      Select();
+    }
+  }
+  
+  return (_state != SC_LINK_STATE_IDLE);
+}
+
+
 //---------------------------------------------------------------------------------------------------------------------
 
 // *************************************************************************
@@ -1137,16 +3738,180 @@ uint8_t SC_CheckSum(uint8_t *message, uint8_t length){
 
 // -------------------------------------------------------------------------
 
+// Update the check of the frame with the next byte
+//  (<type> is one of SC_CHECK_x, start with SC_CHECK_INIT(type))
+uint16_t SC_Check_Update(uint8_t type, uint16_t check, uint8_t data){
+  if(type == SC_CHECK_CRC8)
+    return SC_CRC8(check, data);
+  else if(type == SC_CHECK_CRC16)
+    return SC_CRC16(check, data);
+  else
+    return (check + data); //sum (only 8 bits are sent)
+}
+
+// -------------------------------------------------------------------------
+
+// CRC-8 with the polynomial 0x07 (msb first)
+//  (the table has the remainder of each nibble, so it is 16 bytes long)
+const uint8_t SC_CRC8_TABLE[16] PROGMEM = {
+  0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+uint8_t SC_CRC8(uint8_t crc, uint8_t data){
+  crc ^= data;
+  crc = (crc << 4) ^ pgm_read_byte(&SC_CRC8_TABLE[crc >> 4]); //high nibble
+  crc = (crc << 4) ^ pgm_read_byte(&SC_CRC8_TABLE[crc >> 4]); //low nibble
+  return crc;
+}
+
+// -------------------------------------------------------------------------
+
+// CRC-16/CCITT with the polynomial 0x1021 (msb first)
+//  (the table has the remainder of each nibble, so it is 32 bytes long)
+const uint16_t SC_CRC16_TABLE[16] PROGMEM = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+uint16_t SC_CRC16(uint16_t crc, uint8_t data){
+  crc ^= ((uint16_t)data << 8);
+  crc = (crc << 4) ^ pgm_read_word(&SC_CRC16_TABLE[crc >> 12]); //high nibble
+  crc = (crc << 4) ^ pgm_read_word(&SC_CRC16_TABLE[crc >> 12]); //low nibble
+  return crc;
+}
+
+// -------------------------------------------------------------------------
+
+// Hamming(8,4) codewords of each nibble, with the bits spread to the even bits
+//  (the codeword is the nibble & its parity, so any 2 codewords differ in 4 bits)
+const uint16_t SC_FEC_ENCODE_TABLE[16] PROGMEM = {
+  0x0000, 0x0154, 0x0451, 0x0505, 0x1045, 0x1111, 0x1414, 0x1540,
+  0x4015, 0x4141, 0x4444, 0x4510, 0x5050, 0x5104, 0x5401, 0x5555
+};
+
+// Encode a byte of the frame for SC_FEC_HAMMING
+//  (returns the 16 bits to send, msb first)
+//  NOTE: the bits of the codewords of the high & low nibbles alternate,
+//          so 2 bits in a row (a symbol of SC_CODE_PWM4) are corrected
+uint16_t SC_FEC_Encode(uint8_t data){
+  return (pgm_read_word(&SC_FEC_ENCODE_TABLE[data >> 4]) << 1) | pgm_read_word(&SC_FEC_ENCODE_TABLE[data & 0x0F]);
+}
+
+// -------------------------------------------------------------------------
+
+// Nibble of each word received, with 0x10 if one bit was corrected
+//  (the nibble is kept when 2 bits are wrong, so the check rejects the frame)
+const uint8_t SC_FEC_DECODE_TABLE[256] PROGMEM = {
+  0x00, 0x10, 0x10, 0x00, 0x10, 0x00, 0x00, 0x18, 0x10, 0x00, 0x00, 0x14, 0x00, 0x12, 0x11, 0x00,
+  0x10, 0x01, 0x01, 0x13, 0x01, 0x15, 0x11, 0x01, 0x01, 0x19, 0x11, 0x01, 0x11, 0x01, 0x01, 0x11,
+  0x10, 0x02, 0x02, 0x13, 0x02, 0x12, 0x16, 0x02, 0x02, 0x12, 0x1A, 0x02, 0x12, 0x02, 0x02, 0x12,
+  0x03, 0x13, 0x13, 0x03, 0x1B, 0x03, 0x03, 0x13, 0x17, 0x03, 0x03, 0x13, 0x03, 0x12, 0x11, 0x03,
+  0x10, 0x04, 0x04, 0x14, 0x04, 0x15, 0x16, 0x04, 0x04, 0x14, 0x14, 0x04, 0x1C, 0x04, 0x04, 0x14,
+  0x05, 0x15, 0x1D, 0x05, 0x15, 0x05, 0x05, 0x15, 0x17, 0x05, 0x05, 0x14, 0x05, 0x15, 0x11, 0x05,
+  0x06, 0x1E, 0x16, 0x06, 0x16, 0x06, 0x06, 0x16, 0x17, 0x06, 0x06, 0x14, 0x06, 0x12, 0x16, 0x06,
+  0x17, 0x07, 0x07, 0x13, 0x07, 0x15, 0x16, 0x07, 0x07, 0x17, 0x17, 0x07, 0x17, 0x07, 0x07, 0x1F,
+  0x10, 0x08, 0x08, 0x18, 0x08, 0x18, 0x18, 0x08, 0x08, 0x19, 0x1A, 0x08, 0x1C, 0x08, 0x08, 0x18,
+  0x09, 0x19, 0x1D, 0x09, 0x1B, 0x09, 0x09, 0x18, 0x19, 0x09, 0x09, 0x19, 0x09, 0x19, 0x11, 0x09,
+  0x0A, 0x1E, 0x1A, 0x0A, 0x1B, 0x0A, 0x0A, 0x18, 0x1A, 0x0A, 0x0A, 0x1A, 0x0A, 0x12, 0x1A, 0x0A,
+  0x1B, 0x0B, 0x0B, 0x13, 0x0B, 0x1B, 0x1B, 0x0B, 0x0B, 0x19, 0x1A, 0x0B, 0x1B, 0x0B, 0x0B, 0x1F,
+  0x0C, 0x1E, 0x1D, 0x0C, 0x1C, 0x0C, 0x0C, 0x18, 0x1C, 0x0C, 0x0C, 0x14, 0x0C, 0x1C, 0x1C, 0x0C,
+  0x1D, 0x0D, 0x0D, 0x1D, 0x0D, 0x15, 0x1D, 0x0D, 0x0D, 0x19, 0x1D, 0x0D, 0x1C, 0x0D, 0x0D, 0x1F,
+  0x1E, 0x0E, 0x0E, 0x1E, 0x0E, 0x1E, 0x16, 0x0E, 0x0E, 0x1E, 0x1A, 0x0E, 0x1C, 0x0E, 0x0E, 0x1F,
+  0x0F, 0x1E, 0x1D, 0x0F, 0x1B, 0x0F, 0x0F, 0x1F, 0x17, 0x0F, 0x0F, 0x1F, 0x0F, 0x1F, 0x1F, 0x0F
+};
+
+// Decode the 16 bits received for a byte with SC_FEC_HAMMING
+//  (returns the byte and adds the number of bits corrected to <corrected>)
+uint8_t SC_FEC_Decode(uint16_t coded, uint8_t *corrected){
+  uint8_t high = 0;
+  uint8_t low = 0;
+  for(uint8_t i=0 ; i < 8 ; i++){ //odd bits to the high nibble, even bits to the low nibble
+    high <<= 1;
+    low <<= 1;
+    if(coded & 0x8000)
+      high |= 0x01;
+    if(coded & 0x4000)
+      low |= 0x01;
+    coded <<= 2;
+  }
+  
+  high = pgm_read_byte(&SC_FEC_DECODE_TABLE[high]);
+  low = pgm_read_byte(&SC_FEC_DECODE_TABLE[low]);
+  *corrected += (high >> 4) + (low >> 4);
+  return ((high << 4) | (low & 0x0F));
+}
+
+// -------------------------------------------------------------------------
+
+// Call the handlers of the receivers with the messages received
+//  (returns the number of messages handled)
+//  NOTE: call from loop(), the messages are released after the handler
+uint8_t SC_Dispatch(void){
+  uint8_t count = 0;
+  
+  for(uint8_t i=0 ; i < ReceiversNumber ; i++){
+    SCreceiver *receiver = Receivers[i];
+    if(receiver->_handler == NULL)
+      continue;
+    
+    //only the messages already received (a fast sender cannot block the loop)
+    for(uint8_t n = receiver->GetQueued() ; n > 0 ; n--){
+      const uint8_t *message = receiver->GetView();
+      if(message == NULL)
+        break;
+      receiver->_handler(receiver, message, receiver->GetMessageLength());
+      receiver->Release();
+      count++;
+    }
+  }
+  
+  return count;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the number of ticks of the timer (of SC_TIMER_INTERVAL each)
+//  (free running, overflows every 65536 ticks)
+//  NOTE: the timer runs while the receivers listen or the transmitters send,
+//          so it can be used instead of millis() (stopped with SC_TIMER 0)
+uint16_t SC_Get_Ticks(void){
+  uint8_t oldSREG = SREG;
+  cli(); //changed in the interrupt
+  uint16_t ticks = SC_Ticks;
+  SREG = oldSREG;
+  return ticks;
+}
+
+// -------------------------------------------------------------------------
+
+// Get the timestamp of the timer in [us]
+//  (free running, overflows every 65536 us)
+//  NOTE: must be called with interrupts disabled (ex: in a pin change interrupt)
+uint16_t SC_Get_Timestamp(void){
+  uint16_t ticks = SC_Ticks;
+  uint8_t counts = T_TCNT;
+  
+  //check for a pending tick (counter already reset)
+  //  NOTE: the flag can be set just after reading the counter (near the compare
+  //          match), so the tick is only counted if the counter has wrapped
+  if((T_TIFR & _BV(T_OCFA)) && (counts < (T_OCR / 2)))
+    ticks++;
+  
+  return (ticks * SC_TIMER_INTERVAL) + (uint16_t)((counts * T_PRESCALER_DIV) / (F_CPU / 1000000UL));
+}
+
+// -------------------------------------------------------------------------
+
 void SC_Start_Timer(void){
-  TIMER0_CONFIGURE(); //configure timer
+  TIMER_CONFIGURE(); //configure timer
   SC_TIMER_STARTED = 1; //set
-  TIMER0_ENABLE; //start timer
+  TIMER_ENABLE; //start timer
 }
 
 // -------------------------------------------------------------------------
 
 void SC_Stop_Timer(void){
-  TIMER0_DISABLE; //stop timer
+  TIMER_DISABLE; //stop timer
   SC_TIMER_STARTED = 0; //reset
 }
 
@@ -58,9 +58,12 @@
   
   The library uses Timer 0 (8 bit) in CTC mode for the
   communication, so one must be careful when manipulating
-  timers. If necessary, Timer definitions can be easily
-  changed to use with other timers (perhaps for the next
-  version, and we surely appreciate code suggestions).
+  timers. Timer 2 can be used instead (see SC_TIMER), so
+  Timer 0 is left to millis() and delay(). The receivers
+  can also use the input capture unit of Timer 1 (16 bit)
+  to timestamp the transitions (see SC_USE_ICP) and the
+  transmitters its output compare unit to toggle the pin
+  (see SC_USE_OC).
   
   NOTE: this library is currently valid only for wired
   transmissions (1 wire + GND), and a newer version is
@@ -84,12 +87,36 @@
                         if too high, signal loses precision, must therefore increase Default values & Deviation
                         if too low, cannot handle all signals.
   - SC_DEFAULT_x : depend on the value of SC_SIGNAL_DEVIATION (recommended to be a multiple of this value)
-  - SC_MAX_RECEIVERS : timer interrupt cannot handle too many
+  - SC_MAX_RECEIVERS : timer interrupt cannot handle too many (but only the receivers with a transition
+                       are handled on each tick, because the ports are sampled once per tick)
   - SC_MAX_TRANSMITTERS : timer interrupt cannot handle too many
   
   - Signal duration is recommended to be a multiple of SC_TIMER_INTERVAL
+  
+  - SC_FAST_IO : 1 to access the port registers directly in the timer interrupt (cached on Create())
+                 0 to use digitalWrite() & digitalRead() (slower, only useful for comparison)
+  - SC_USE_PCINT : 1 to enable the pin change engine for the receivers (see SCreceiver::SetEngine())
+                   NOTE: defines the PCINTx interrupts, so it cannot be used with SoftwareSerial
+  - SC_USE_ICP : 1 to enable the input capture engine for the receivers (see SCreceiver::SetEngine())
+                 NOTE: Timer 1 runs free (16 bits, prescaler of 8), so it cannot be used with Servo
+                       and only one receiver (on SC_ICP_PIN) can use this engine
+  - SC_USE_OC : 1 to enable the output compare engine for the transmitters (see SCtransmitter::SetEngine())
+                NOTE: same restrictions as SC_USE_ICP (only one transmitter, on SC_OC_PIN)
+  - SC_TIMER : the timer of the ticks (0 or 2, both 8 bits in CTC mode)
+               NOTE: Timer 0 is also used by millis() & delay() and Timer 2 by tone()
+  - SC_TRANSMITTER_BUFFER : 0 to remove the buffer of the frame from the transmitters (saves SC_TOTAL_MESSAGE_SIZE
+                            bytes of RAM for each one), then Send() needs a queue (see SCtransmitter::SetQueue()),
+                            also for SCfragmenter & SCnegotiator
+                            NOTE: SendBuffer() & Send_P() never use the buffer
 */
 
+#define SC_FAST_IO 1
+#define SC_USE_PCINT 0
+#define SC_USE_ICP 0
+#define SC_USE_OC 0
+#define SC_TIMER 0
+#define SC_TRANSMITTER_BUFFER 1
+
 
 // state of the transmitter/receiver
 #define SC_STATE_EMPTY 0
@@ -106,11 +133,66 @@
 #define SC_ZERO 0
 #define SC_ONE 1
 #define SC_START 2
+#define SC_END 3 //end of transmission
+#define SC_SYMBOL_1 4 //symbol 01 of SC_CODE_PWM4 (00 is ZERO & 11 is ONE)
+#define SC_SYMBOL_2 5 //symbol 10 of SC_CODE_PWM4
+#define SC_SKIP 0x40 //frame to another receiver (wait for the next START)
 #define SC_FOUND 0x80
 
+// pulse classes (bits >> a pulse can match more than one window)
+#define SC_PULSE_SHORT 0x01 //LOW time of the ONE signal
+#define SC_PULSE_LONG 0x02 //HIGH time of the ONE signal
+#define SC_PULSE_START 0x04 //HIGH or LOW time of the START signal
+#define SC_PULSE_MID_SHORT 0x08 //1st intermediate time of SC_CODE_PWM4
+#define SC_PULSE_MID_LONG 0x10 //2nd intermediate time of SC_CODE_PWM4
+#define SC_PULSE_START_HALF 0x20 //LOW time of the START + the 1st half of a ZERO of SC_CODE_MANCHESTER
+
+// index of the acceptance windows
+#define SC_PULSE_INDEX_SHORT 0
+#define SC_PULSE_INDEX_LONG 1
+#define SC_PULSE_INDEX_START_HIGH 2
+#define SC_PULSE_INDEX_START_LOW 3
+#define SC_PULSE_INDEX_MID_SHORT 4
+#define SC_PULSE_INDEX_MID_LONG 5
+#define SC_PULSE_INDEX_START_HALF 6
+#define SC_PULSE_INDEX_START_RANGE 7 //HIGH time of the START with auto baud (see SC_AUTO_BAUD_RANGE)
+
+// half bit of SC_CODE_MANCHESTER waiting for the 2nd half (or SC_HALF_NONE)
+#define SC_HALF_NONE 0xFF
+
+// engine of the receivers & transmitters
+#define SC_ENGINE_TIMER 0 //sample or write the pin on every tick of the timer
+#define SC_ENGINE_PCINT 1 //timestamp the transitions in the pin change interrupt
+#define SC_ENGINE_ICP 2 //timestamp the transitions with the input capture unit of Timer 1
+#define SC_ENGINE_OC 3 //toggle the pin with the output compare unit of Timer 1 (transmitters only)
+
+// line code of the bits (see SetCode())
+#define SC_CODE_PWM 0 //1 bit per symbol (ONE is HIGH + LOW, ZERO is LOW + HIGH)
+#define SC_CODE_PWM4 1 //2 bits per symbol (4 levels between the times of the ONE & ZERO)
+#define SC_CODE_MANCHESTER 2 //1 bit per period (ONE is HIGH + LOW, ZERO is LOW + HIGH, each for half of the period)
+
+// check of the frame (see SetCheck())
+#define SC_CHECK_SUM 0 //8 bit sum of the message
+#define SC_CHECK_CRC8 1 //CRC-8 (polynomial 0x07) of the ID, length & message
+#define SC_CHECK_CRC16 2 //CRC-16/CCITT (polynomial 0x1021, initial value 0xFFFF) of the ID, length & message
+#define SC_CHECK_INIT(type) (((type) == SC_CHECK_CRC16) ? 0xFFFF : 0x0000)
+#define SC_CHECK_SIZE(type) (((type) == SC_CHECK_CRC16) ? 2 : 1) //in bytes
+
+// correction of the frame (see SetCorrection())
+#define SC_FEC_NONE 0 //8 bits per byte
+#define SC_FEC_HAMMING 1 //16 bits per byte (2 codewords of Hamming(8,4) with the bits interleaved)
+#define SC_FEC_FIRST_BIT(type) (((type) == SC_FEC_HAMMING) ? 15 : 7) //1st bit sent for each byte of the frame (msb)
+
+// source of the frame of a transmitter
+#define SC_SOURCE_FRAME 0 //frame created by Send() (buffer or slot of the queue)
+#define SC_SOURCE_RAM 1 //message read from the buffer of the caller (see SendBuffer())
+#define SC_SOURCE_PROGMEM 2 //message read from the flash memory (see Send_P())
+
 // Signal Constants
 #define SC_SIGNAL_DEVIATION 100 //deviation of the signal value in [us]
+#define SC_AUTO_BAUD_RANGE 2 //the START can last from 1/x to x times the time of the receiver (see SetAutoBaud())
 #define SC_SIGNAL_MAX_TIME 65530 //because of uint16_t
+#define SC_SIGNAL_MAX_TICKS SC_US_TO_TICKS(SC_SIGNAL_MAX_TIME)
 
 // MINIMUM values
 #define SC_MIN_DURATION 400
@@ -118,6 +200,11 @@
 #define SC_MIN_START_DURATION 1000
 #define SC_MIN_START_INTERVAL (3 * SC_SIGNAL_DEVIATION) //must consider deviation
 
+// MINIMUM values of the Timer 1 engines (the transitions are timestamped or generated by the hardware)
+#define SC_T1_SIGNAL_DEVIATION 20 //deviation of the signal value in [us]
+#define SC_T1_MIN_DURATION 100
+#define SC_T1_MIN_DURATION_INTERVAL (2 * SC_T1_SIGNAL_DEVIATION) //must consider deviation
+
 // DEFAULT values
 #define SC_DEFAULT_CHANNEL 0x1 //ONLY 4 bits
 #define SC_DEFAULT_DURATION_HIGH 700
@@ -127,7 +214,38 @@
 
 // size of the message & of the buffer
 #define SC_MESSAGE_SIZE 30 //in bytes
-#define SC_TOTAL_MESSAGE_SIZE (SC_MESSAGE_SIZE + 3) //include (ID + Channel) + (message_length) + (CheckSum)
+#define SC_TOTAL_MESSAGE_SIZE (SC_MESSAGE_SIZE + 4) //include (ID + Channel) + (message_length) + (Check, up to 2 bytes)
+
+// fragments of the large messages (see SCfragmenter & SCreassembler)
+#define SC_FRAGMENT_SIZE (SC_MESSAGE_SIZE - 1) //in bytes (the 1st byte of the message is the control)
+#define SC_FRAGMENT_SEQUENCE 0x3F //sequence number of the fragment (6 bits)
+#define SC_FRAGMENT_FIRST 0x40 //first fragment of the message
+#define SC_FRAGMENT_LAST 0x80 //last fragment of the message
+
+// negotiation of the times of a link (see SCnegotiator)
+#define SC_LINK_STEPS 8 //maximum number of timings probed
+#define SC_LINK_STEP 75 //each timing is x% of the previous one
+#define SC_LINK_FRAMES 10 //test frames of each timing
+#define SC_LINK_TIMEOUT 1000 //for the answers & between the test frames in [ms]
+#define SC_LINK_TRIES 3 //SC_LINK_CONFIRM sent until SC_LINK_READY (within SC_LINK_TIMEOUT)
+
+// messages of the negotiation (1st byte)
+#define SC_LINK_SETUP 1 //[step, high (msb, lsb), low (msb, lsb)] >> the receiver changes the times for the test frames
+#define SC_LINK_READY 2 //[step, 0] >> answer to SC_LINK_SETUP, SC_LINK_SELECT & SC_LINK_CONFIRM
+#define SC_LINK_TEST 3 //[step, sequence, pattern...] >> test frame (SC_MESSAGE_SIZE bytes)
+#define SC_LINK_RESULT 4 //[step, frames] >> answer after the test frames
+#define SC_LINK_SELECT 5 //[step, high (msb, lsb), low (msb, lsb)] >> the receiver changes the times until SC_LINK_CONFIRM
+#define SC_LINK_CONFIRM 6 //[step, 0] >> sent with the selected times, the receiver keeps them
+
+// state of the negotiation
+#define SC_LINK_STATE_IDLE 0 //answers to the other side (see Update())
+#define SC_LINK_STATE_SETUP 1 //waiting for SC_LINK_READY
+#define SC_LINK_STATE_SENDING 2 //sending the test frames
+#define SC_LINK_STATE_RESULT 3 //waiting for SC_LINK_RESULT
+#define SC_LINK_STATE_SELECT 4 //waiting for SC_LINK_READY of the selected timing
+#define SC_LINK_STATE_TESTING 5 //receiving the test frames
+#define SC_LINK_STATE_CONFIRM 6 //waiting for SC_LINK_READY of SC_LINK_CONFIRM
+#define SC_LINK_STATE_CHECKING 7 //waiting for SC_LINK_CONFIRM with the selected timing
 
 
 
@@ -139,13 +257,86 @@
 #define SC_TIMER_INTERVAL 100 // in [us]
 
 #if ((SC_TIMER_INTERVAL * F_CPU / 1000000) > 255)          //prescaler of 8
-#define T_OCR0A (SC_TIMER_INTERVAL * F_CPU / 1000000 / 8)
+#define T_OCR (SC_TIMER_INTERVAL * F_CPU / 1000000 / 8)
 #define T_PRESCALER 0x02
+#define T_PRESCALER_DIV 8
 #else                                                      //prescaler of 1
-#define T_OCR0A (SC_TIMER_INTERVAL * F_CPU / 1000000)
+#define T_OCR (SC_TIMER_INTERVAL * F_CPU / 1000000)
 #define T_PRESCALER 0x01
+#define T_PRESCALER_DIV 1
+#endif
+
+// registers of the timer of the ticks (same bits for Timer 0 & Timer 2)
+#if (SC_TIMER == 0)
+#define T_TCCRA TCCR0A
+#define T_TCCRB TCCR0B
+#define T_TCNT TCNT0
+#define T_OCRA OCR0A
+#define T_TIFR TIFR0
+#define T_TIMSK TIMSK0
+#define T_OCFA OCF0A
+#define T_COMPA_vect TIMER0_COMPA_vect
+#elif (SC_TIMER == 2)
+#define T_TCCRA TCCR2A
+#define T_TCCRB TCCR2B
+#define T_TCNT TCNT2
+#define T_OCRA OCR2A
+#define T_TIFR TIFR2
+#define T_TIMSK TIMSK2
+#define T_OCFA OCF2A
+#define T_COMPA_vect TIMER2_COMPA_vect
+#else
+#error SC_TIMER must be 0 or 2!
 #endif
 
+// Timer 1 (input capture & output compare engines)
+#define T1_PRESCALER 0x02 //prescaler of 8
+#define T1_PRESCALER_DIV 8
+#define SC_US_TO_COUNTS(us) ((uint32_t)(us) * (F_CPU / 1000000UL) / T1_PRESCALER_DIV)
+#define SC_ICP_MAX_TIME ((uint16_t)(0xFFFFUL * T1_PRESCALER_DIV / (F_CPU / 1000000UL))) //the counter overflows after this time
+#define SC_ICP_MAX_TICKS ((SC_ICP_MAX_TIME / SC_TIMER_INTERVAL) - 1) //longer signals are not measured
+
+// the input capture & output compare A pins of Timer 1
+#if defined(__AVR_ATmega328P__) || defined(__AVR_ATmega328__) || defined(__AVR_ATmega168__) || defined(__AVR_ATmega168P__) || defined(__AVR_ATmega8__)
+#define SC_ICP_PIN 8
+#define SC_OC_PIN 9
+#elif defined(__AVR_ATmega32U4__)
+#define SC_ICP_PIN 4
+#define SC_OC_PIN 9
+#elif defined(__AVR_ATmega1280__) || defined(__AVR_ATmega2560__)
+#define SC_OC_PIN 11
+#endif
+
+#define SC_US_TO_TICKS(us) ((uint16_t)(((uint32_t)(us) + SC_TIMER_INTERVAL - 1) / SC_TIMER_INTERVAL)) //rounded up
+
+// acceptance window in ticks of a signal measured by the timer (|ticks * SC_TIMER_INTERVAL - us| <= SC_SIGNAL_DEVIATION)
+#define SC_WINDOW_MIN_TICKS(us) ((uint16_t)(((us) > SC_SIGNAL_DEVIATION) ? (((uint32_t)(us) - SC_SIGNAL_DEVIATION + SC_TIMER_INTERVAL - 1) / SC_TIMER_INTERVAL) : 0))
+#define SC_WINDOW_MAX_TICKS(us) ((uint16_t)(((uint32_t)(us) + SC_SIGNAL_DEVIATION) / SC_TIMER_INTERVAL))
+
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// slot of the queue of messages of a receiver (see SCreceiver::SetQueue())
+//  (the whole frame is received in the slot, the message starts at frame[2])
+struct SCmessage{
+  uint8_t length;
+  uint8_t frame[SC_TOTAL_MESSAGE_SIZE];
+};
+
+class SCreceiver;
+
+// handler of the messages of a receiver (see SCreceiver::SetHandler() and SC_Dispatch())
+typedef void (*SChandler)(SCreceiver *receiver, const uint8_t *message, uint8_t length);
+
+// sink of the fragments of a large message (see SCreassembler)
+typedef void (*SCsink)(const uint8_t *data, uint8_t length, uint16_t offset);
+
+// slot of the queue of frames of a transmitter (see SCtransmitter::SetQueue())
+struct SCframe{
+  uint8_t length;
+  uint8_t data[SC_TOTAL_MESSAGE_SIZE];
+};
 
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -154,9 +345,16 @@ class SCtransmitter{
   private:
     uint8_t _initialized; // TRUE if initialized (pins and id set)
     uint8_t _pin;
+    volatile uint8_t *_port; // output register of the pin
+    uint8_t _mask; // bit mask of the pin in the register
+    uint8_t _port_index; // index of the register in the list of ports (written once per tick)
     uint8_t _id; // [1 - 15] # 0 means no destination (is SET for each transmission, depends of target Receiver's ID)
     uint8_t _channel; // [1 - 15] # 0 means no channel
     uint8_t _state; // the state of the transmitter
+    uint8_t _engine; // the engine used to send the signals
+    uint8_t _code; // the line code of the bits (SC_CODE_x)
+    uint8_t _check_type; // the check of the frame (SC_CHECK_x)
+    uint8_t _fec_type; // the correction of the frame (SC_FEC_x)
     
     uint16_t _start_duration_high;
     uint16_t _start_duration_low;
@@ -164,36 +362,90 @@ class SCtransmitter{
     uint16_t _duration_high;
     uint16_t _duration_low;
     
-    uint16_t _elapsed_time; // used to get values
+    uint16_t _ticks[6][2]; // duration of each signal in the units of the engine [ZERO, ONE, START, -, SYMBOL_1, SYMBOL_2][HIGH, LOW]
+    uint16_t _ticks_left; // ticks until the next signal
     uint8_t _signal; //signal to send
     uint8_t _signal_state; // signal state
     
+#if SC_TRANSMITTER_BUFFER
     uint8_t _buffer[SC_TOTAL_MESSAGE_SIZE];
+#endif
     uint8_t _buffer_length;
+    uint8_t *_frame; //frame being sent (_buffer or a slot of the queue)
     uint8_t _index; //index of the message to send
     int8_t _bit; //bit of the index to send
+    uint16_t _data; //bits of the byte of the index to send (16 with SC_FEC_HAMMING)
+    uint8_t _half; //position in the bit with SC_CODE_MANCHESTER (0: start, 1: middle, 2: after the last bit)
+    
+    uint8_t _source; //source of the frame (SC_SOURCE_x)
+    const uint8_t *_payload; //message sent without copy (see SendBuffer())
+    uint8_t _header[2]; //ID+Channel & Length of the message sent without copy
+    uint16_t _check; //check of the message sent without copy (updated as each byte is sent)
+    
+    uint8_t _burst; //number of frames sent after one START
+    uint8_t _burst_count; //frames sent after the last START
+    
+    SCframe *_queue; // slots of the queue of frames (NULL if only one frame)
+    uint8_t _queue_size; // number of slots
+    volatile uint8_t _queue_head; // next slot to write (only changed outside the interrupt)
+    volatile uint8_t _queue_tail; // frame being sent (only changed in the interrupt while sending)
+    
+    int8_t Begin(void); //start the transmission
+    uint8_t Build(uint8_t *frame, const uint8_t *prefix, const uint8_t *message, uint8_t length); //create the frame of the message
+    uint8_t Load(void); //called when a byte is sent
+    uint16_t Next(void); //called when a signal is sent
+    uint16_t NextHalf(void); //called when a signal of SC_CODE_MANCHESTER is sent
+    uint8_t NextFrame(void); //called when a frame is sent
+    void Prepare(void); //called when a bit is sent
+    int8_t SendFragment(uint8_t control, const uint8_t *data, uint8_t size); //for SCfragmenter
+    int8_t SendFrame(const uint8_t *prefix, const uint8_t *message, uint8_t length);
+    int8_t SendFrom(const uint8_t *message, uint8_t length, uint8_t source);
+    int8_t Validate(uint8_t length); //validate the values of the transmission
+    void UpdateTicks(void); //called when the durations or the engine change
+    
+    friend class SCfragmenter; //to send the fragments without copy
+  
+  protected:
+    void SetTimes(uint16_t high_time, uint16_t low_time, uint16_t start_high_time, uint16_t start_low_time); //for SCtransmitterT (times already validated)
   
   public:
     SCtransmitter(void);
     SCtransmitter(uint8_t pin);
     ~SCtransmitter(void);
     
+    void Compare(void); //DO NOT call from outside the library (is public because of output compare interrupt)
     void Create(uint8_t pin); //for when the default constructor is called
     
+    void Flush(void);
+    
     uint8_t GetChannel(void);
+    uint8_t GetCheck(void);
+    uint8_t GetCode(void);
+    uint8_t GetCorrection(void);
     uint16_t GetDurationHIGH(void);
     uint16_t GetDurationLOW(void);
+    uint8_t GetEngine(void);
+    uint8_t GetPending(void);
     uint8_t GetPin(void);
     uint16_t GetStartDurationHIGH(void);
     uint16_t GetStartDurationLOW(void);
     uint8_t GetState(void);
     
+    uint8_t isReady(void);
     uint8_t isSending(void);
     int8_t Send(uint8_t *message, uint8_t length);
+    int8_t Send_P(const uint8_t *message, uint8_t length);
+    int8_t SendBuffer(const uint8_t *message, uint8_t length);
 
+    uint8_t SetBurst(uint8_t frames);
     void SetChannel(uint8_t channel); //set the channel of the communication
+    uint8_t SetCheck(uint8_t type);
+    uint8_t SetCode(uint8_t code);
+    uint8_t SetCorrection(uint8_t type);
+    uint8_t SetEngine(uint8_t engine);
     void SetID(uint8_t id); //set the id of the receiver
     uint8_t SetInterval(uint16_t high_time, uint16_t low_time);
+    uint8_t SetQueue(SCframe *slots, uint8_t number);
     uint8_t SetStart(uint16_t high_time, uint16_t low_time);
     
     void Stop(void);
@@ -211,9 +463,16 @@ class SCreceiver{
   private:
     uint8_t _initialized; // TRUE if initialized (pins and id set)
     uint8_t _pin;
+    volatile uint8_t *_port; // input register of the pin
+    uint8_t _mask; // bit mask of the pin in the register
+    uint8_t _port_index; // index of the register in the list of ports (read once per tick)
     uint8_t _id; // [1 - 15] # 0 means not initialized (is FIXED for the Receiver)
     uint8_t _channel; // [1 - 15] # 0 means no channel
     uint8_t _state; // the state of the receiver
+    uint8_t _engine; // the engine used to receive the signals
+    uint8_t _code; // the line code of the bits (SC_CODE_x)
+    uint8_t _check_type; // the check of the frame (SC_CHECK_x)
+    uint8_t _fec_type; // the correction of the frame (SC_FEC_x)
     
     uint16_t _start_duration_high;
     uint16_t _start_duration_low;
@@ -221,43 +480,110 @@ class SCreceiver{
     uint16_t _duration_high;
     uint16_t _duration_low;
     
-    uint16_t _elapsed_time; // used to get values
-    uint16_t _signal[2]; // the times of the signal [0 - HIGH ; 1 - LOW]
+    uint16_t _elapsed_time; // duration of the previous signal (in ticks, [us] or counts of Timer 1, depending on the engine)
+    uint16_t _last_tick; // tick of the last transition
+    uint16_t _last_edge; // timestamp of the last transition (pin change & input capture engines)
+    uint16_t _window[8][2]; // acceptance windows of the pulses in the units of the engine [SC_PULSE_INDEX_x][min, max]
+    uint8_t _pulse; // the class of the last HIGH pulse (SC_PULSE_x bits)
+    uint8_t _half; // the level of the 1st half of the bit with SC_CODE_MANCHESTER (or SC_HALF_NONE)
+    
+    uint8_t _auto_baud; // TRUE if the timing is learned from the START (see SetAutoBaud())
+    uint16_t _scale; // from the timing of the transmitter to the one of the receiver (8.8 fixed point, 256 is the same)
+    uint16_t _start_high; // duration of the last HIGH in the range of the START (in the units of the engine)
+    uint16_t _start_reference; // HIGH time of the START of the receiver (in the units of the engine)
     uint8_t _previous_signal; // the previous value received
     uint8_t _signal_state; // signal state + (byte 8) to check if ignore previous signal
+    uint16_t _filtered; // number of frames to other receivers
+    uint16_t _dropped; // number of valid messages lost (not read in time or queue full)
+    uint16_t _corrected; // number of bits corrected in the valid frames (see SetCorrection())
+    uint8_t _frame_corrected; // number of bits corrected in the frame being received
+    
+    SCmessage *_queue; // slots of the queue of messages (NULL if only one message)
+    uint8_t _queue_size; // number of slots
+    volatile uint8_t _queue_head; // next slot to write (only changed in the interrupt)
+    volatile uint8_t _queue_tail; // oldest message (only changed outside the interrupt)
+    
+    volatile uint8_t _borrowed; // TRUE if the message is read in place (see GetView())
+    SChandler _handler; // called for each message (see SC_Dispatch())
     
     uint8_t _buffer[SC_TOTAL_MESSAGE_SIZE];
     uint8_t _buffer_length;
+    uint8_t *_frame; // frame being received (_buffer or the free slot of the queue)
     int8_t _bit; //bit of the index received
+    uint16_t _coded; // bits of the byte being received with SC_FEC_HAMMING
+    uint16_t _check; // check of the message received so far (see StoreBit())
+    uint16_t _skip_bits; // bits left of a frame to another receiver in a burst (see Filter())
     
+    uint8_t Classify(uint16_t duration, uint8_t level); //called at the end of every pulse
+    void Filter(void); //called when a bit is stored
+    uint8_t Finish(void); //called at the end of the frame (last bit or time overflow)
+    uint8_t Guess(uint8_t low); //called when a symbol is invalid with the correction
+    uint8_t InWindow(uint16_t duration, uint8_t index); //called when classifying a pulse
+    uint8_t Level(uint8_t pulse); //called when a symbol of SC_CODE_PWM4 is received
+    void NextFrame(void); //called at the end of a frame that a burst can follow
+    uint16_t Normalize(uint16_t duration, uint16_t scale); //called at the end of every pulse with auto baud
+    uint8_t StoreBit(uint8_t value); //called when a bit is received
+    uint8_t StoreHalves(uint8_t level, uint8_t pulse); //called when a pulse of SC_CODE_MANCHESTER is received
+    void Timeout(void); //called when the line is idle for SC_SIGNAL_MAX_TIME
+    void Transition(uint8_t signal); //called on every transition of the signal
+    void UpdateWindows(void); //called when the durations or the engine change
     uint8_t ValidateMessage(void); //called when Receive() has finished
+    
+    friend void SC_Timer_Tick(void); //to check the pin in the sampled ports
+    friend uint8_t SC_Dispatch(void); //to call the handler
+  
+  protected:
+    void SetTimes(uint16_t high_time, uint16_t low_time, uint16_t start_high_time, uint16_t start_low_time); //for SCreceiverT (times already validated)
   
   public:
     SCreceiver(void);
     SCreceiver(uint8_t pin, uint8_t id);
     ~SCreceiver(void);
     
+    void Capture(uint16_t timestamp, uint8_t signal); //DO NOT call from outside the library (is public because of input capture interrupt)
+    void CheckTimeout(void); //DO NOT call from outside the library (is public because of timer interrupt)
     uint8_t ClearBuffer(void); //manually reset buffer so one can identify when new message has arrived
     void Create(uint8_t pin, uint8_t id); //for when the default constructor is called
     
+    void Edge(uint16_t timestamp); //DO NOT call from outside the library (is public because of pin change interrupt)
+    
     uint8_t GetChannel(void);
+    uint8_t GetCheck(void);
+    uint8_t GetCode(void);
+    uint8_t GetCorrection(void);
+    uint16_t GetCorrectedBits(void);
     uint16_t GetDurationHIGH(void);
     uint16_t GetDurationLOW(void);
+    uint16_t GetDroppedFrames(void);
+    uint8_t GetEngine(void);
+    uint16_t GetFilteredFrames(void);
     uint8_t GetID(void);
     uint8_t GetMessage(uint8_t *buffer);
     uint8_t GetMessageLength(void);
     uint8_t GetPin(void);
+    uint8_t GetQueued(void);
     uint16_t GetStartDurationHIGH(void);
     uint16_t GetStartDurationLOW(void);
     uint8_t GetState(void);
+    uint16_t GetTiming(void);
+    const uint8_t *GetView(void);
     
     uint8_t isListenning(void);
     int8_t Listen(void);
+    uint8_t PopMessage(uint8_t *buffer);
     void Receive(void); //DO NOT call from outside the library (is public because of timer interrupt)
+    uint8_t Release(void);
     void Reset(void); //stop the communication and reset the buffer length
     
+    void SetAutoBaud(uint8_t enable);
     void SetChannel(uint8_t channel);
+    uint8_t SetCheck(uint8_t type);
+    uint8_t SetCode(uint8_t code);
+    uint8_t SetCorrection(uint8_t type);
+    uint8_t SetEngine(uint8_t engine);
+    void SetHandler(SChandler handler);
     uint8_t SetInterval(uint16_t high_time, uint16_t low_time);
+    uint8_t SetQueue(SCmessage *slots, uint8_t number);
     uint8_t SetStart(uint16_t high_time, uint16_t low_time);
     
     void Stop(void);
@@ -266,18 +592,251 @@ class SCreceiver{
 
 //---------------------------------------------------------------------------------------------------------------------
 
-const uint8_t SC_MAX_RECEIVERS = 5;
+// Send messages larger than SC_MESSAGE_SIZE in fragments
+//  (use a queue in the transmitter to send the fragments back to back)
+class SCfragmenter{
+  private:
+    SCtransmitter *_transmitter;
+    const uint8_t *_data; // message being sent (must not change until sent)
+    uint16_t _length; // length of the message
+    uint16_t _offset; // next byte to send
+    uint8_t _sequence; // sequence number of the next fragment
+    uint8_t _sending; // TRUE while there are fragments to send
+    uint16_t _fragments; // number of fragments sent
+  
+  public:
+    SCfragmenter(SCtransmitter *transmitter);
+    
+    uint16_t GetFragments(void);
+    uint8_t isSending(void);
+    uint8_t Send(const uint8_t *data, uint16_t length);
+    uint8_t Update(void); //call from loop()
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// Receive messages larger than SC_MESSAGE_SIZE in fragments
+//  (in a buffer or in a sink, so the whole message does not need to be in RAM)
+//  NOTE: the receiver is used only for the fragments (do not set a handler)
+class SCreassembler{
+  private:
+    SCreceiver *_receiver;
+    uint8_t *_buffer; // buffer of the message (NULL if using the sink)
+    uint16_t _size; // size of the buffer
+    SCsink _sink; // called for each fragment (NULL if using the buffer)
+    
+    uint8_t _receiving; // TRUE after the first fragment
+    uint8_t _sequence; // sequence number of the next fragment (0xFF before the first one)
+    uint16_t _length; // bytes received of the message
+    uint16_t _lost; // number of fragments lost
+    uint16_t _dropped; // number of messages lost (fragments lost or buffer too small)
+    uint16_t _last_tick; // tick of the last call of Update() (see SC_Get_Ticks())
+    uint32_t _elapsed; // ticks since the first fragment
+    uint32_t _throughput; // of the last message in [bytes/s]
+    
+    void Drop(void);
+  
+  public:
+    SCreassembler(SCreceiver *receiver, uint8_t *buffer, uint16_t size);
+    SCreassembler(SCreceiver *receiver, SCsink sink);
+    
+    uint16_t GetDroppedMessages(void);
+    uint16_t GetLength(void);
+    uint16_t GetLostFragments(void);
+    uint32_t GetThroughput(void);
+    uint8_t Update(void); //call from loop()
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// Negotiate the fastest times of a link with test frames
+//  (the transmitter sends to the other side and the receiver gets the answers,
+//    so each side has a transmitter & a receiver)
+//  NOTE: both sides start with the same times and the answers keep their times
+//  NOTE: the transmitter & the receiver are used only for the negotiation while it runs
+class SCnegotiator{
+  private:
+    SCtransmitter *_transmitter;
+    SCreceiver *_receiver;
+    
+    uint8_t _state; // SC_LINK_STATE_x
+    uint8_t _step; // timing being probed (or tested)
+    uint8_t _steps; // number of timings probed
+    int8_t _selected; // fastest timing that met the target (-1 if none)
+    uint8_t _target; // maximum frame error rate in [%]
+    uint8_t _count; // test frames sent or received (or SC_LINK_CONFIRM sent)
+    uint16_t _base_high; // times before the negotiation
+    uint16_t _base_low;
+    uint16_t _time; // tick of the start of the timeout
+    uint16_t _last_tick; // tick of the last call of Update() (see SC_Get_Ticks())
+    uint32_t _elapsed; // duration of the test frames in ticks
+    
+    uint16_t _high[SC_LINK_STEPS]; // times of each timing
+    uint16_t _low[SC_LINK_STEPS];
+    uint8_t _received[SC_LINK_STEPS]; // test frames received of each timing
+    uint16_t _goodput[SC_LINK_STEPS]; // of each timing in [bytes/s]
+    
+    void Answer(uint8_t type, uint8_t value);
+    void Probe(uint8_t step);
+    void Select(void);
+    void SendTimes(uint8_t type, uint8_t step);
+  
+  public:
+    SCnegotiator(SCtransmitter *transmitter, SCreceiver *receiver);
+    
+    uint16_t GetDurationHIGH(uint8_t step);
+    uint16_t GetDurationLOW(uint8_t step);
+    uint8_t GetErrorRate(uint8_t step);
+    uint16_t GetGoodput(uint8_t step);
+    int8_t GetSelected(void);
+    uint8_t GetState(void);
+    uint8_t GetSteps(void);
+    uint8_t isNegotiating(void);
+    uint8_t Start(uint8_t target);
+    uint8_t Update(void); //call from loop() (on both sides)
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+#if (__cplusplus >= 201103L) //templates need C++11 (constexpr & static_assert)
+
+/*
+  Compile time specialised Transmitters & Receivers
+  
+  The pin, the ID and the times are template parameters,
+  so invalid values are rejected when compiling, instead
+  of being corrected by SetInterval() and SetStart().
+  The instances are regular SCtransmitter & SCreceiver
+  objects otherwise.
+  NOTE: only the validation is done when compiling. The
+        interrupts reach the instances through pointers to
+        SCtransmitter & SCreceiver, so they still use the
+        ticks & windows of each instance (computed once by
+        SetTimes()). Reading the constants of the profile
+        would need a virtual call per signal, which costs
+        more than loading the values from the instance.
+  
+  ex: typedef SCprofile<900, 300, 2500, 1700> MyProfile;
+      SCtransmitterT<4, MyProfile> Trmtr;
+      SCreceiverT<5, 1, MyProfile> Rcvr;
+*/
+
+// Times of the signals in [us]
+template <uint16_t HighTime, uint16_t LowTime,
+          uint16_t StartHighTime = SC_DEFAULT_START_DURATION_HIGH, uint16_t StartLowTime = SC_DEFAULT_START_DURATION_LOW>
+struct SCprofile {
+  static constexpr uint16_t duration_high = HighTime;
+  static constexpr uint16_t duration_low = LowTime;
+  static constexpr uint16_t start_duration_high = StartHighTime;
+  static constexpr uint16_t start_duration_low = StartLowTime;
+  
+  static constexpr uint16_t ticks_high = SC_US_TO_TICKS(HighTime);
+  static constexpr uint16_t ticks_low = SC_US_TO_TICKS(LowTime);
+  static constexpr uint16_t start_ticks_high = SC_US_TO_TICKS(StartHighTime);
+  static constexpr uint16_t start_ticks_low = SC_US_TO_TICKS(StartLowTime);
+  
+  // acceptance windows of the receiver in ticks (see SC_WINDOW_MIN_TICKS() & SC_WINDOW_MAX_TICKS())
+  //  (for the static_assert below, the receiver computes the same values in UpdateWindows())
+  static constexpr uint16_t window_short_min = SC_WINDOW_MIN_TICKS(LowTime);
+  static constexpr uint16_t window_short_max = SC_WINDOW_MAX_TICKS(LowTime);
+  static constexpr uint16_t window_long_min = SC_WINDOW_MIN_TICKS(HighTime);
+  static constexpr uint16_t window_long_max = SC_WINDOW_MAX_TICKS(HighTime);
+  static constexpr uint16_t window_start_high_min = SC_WINDOW_MIN_TICKS(StartHighTime);
+  static constexpr uint16_t window_start_high_max = SC_WINDOW_MAX_TICKS(StartHighTime);
+  static constexpr uint16_t window_start_low_min = SC_WINDOW_MIN_TICKS(StartLowTime);
+  static constexpr uint16_t window_start_low_max = SC_WINDOW_MAX_TICKS(StartLowTime);
+  
+  static_assert(((uint32_t)HighTime + LowTime) >= SC_MIN_DURATION, "SCprofile: HIGH + LOW shorter than SC_MIN_DURATION");
+  static_assert((HighTime >= SC_MIN_DURATION_INTERVAL) && (LowTime >= SC_MIN_DURATION_INTERVAL), "SCprofile: HIGH or LOW shorter than SC_MIN_DURATION_INTERVAL");
+  static_assert((HighTime <= SC_SIGNAL_MAX_TIME) && (LowTime <= SC_SIGNAL_MAX_TIME), "SCprofile: HIGH or LOW longer than SC_SIGNAL_MAX_TIME");
+  static_assert(((HighTime > LowTime) ? (HighTime - LowTime) : (LowTime - HighTime)) >= (2 * SC_SIGNAL_DEVIATION), "SCprofile: ONE and ZERO cannot be distinguished (HIGH and LOW must differ by 2 * SC_SIGNAL_DEVIATION)");
+  static_assert(ticks_high != ticks_low, "SCprofile: HIGH and LOW have the same number of ticks");
+  static_assert((window_short_min <= ticks_low) && (ticks_low <= window_short_max) && (window_long_min <= ticks_high) && (ticks_high <= window_long_max), "SCprofile: the ticks sent are not accepted by the receiver (increase SC_SIGNAL_DEVIATION)");
+  
+  static_assert(((uint32_t)StartHighTime + StartLowTime) >= SC_MIN_START_DURATION, "SCprofile: START shorter than SC_MIN_START_DURATION");
+  static_assert((StartHighTime >= SC_MIN_START_INTERVAL) && (StartLowTime >= SC_MIN_START_INTERVAL), "SCprofile: START HIGH or LOW shorter than SC_MIN_START_INTERVAL");
+  static_assert((StartHighTime <= SC_SIGNAL_MAX_TIME) && (StartLowTime <= SC_SIGNAL_MAX_TIME), "SCprofile: START HIGH or LOW longer than SC_SIGNAL_MAX_TIME");
+};
+
+typedef SCprofile<SC_DEFAULT_DURATION_HIGH, SC_DEFAULT_DURATION_LOW> SCdefaultProfile;
+
+//---------------
+
+template <uint8_t Pin, class Profile = SCdefaultProfile>
+class SCtransmitterT : public SCtransmitter {
+#ifdef NUM_DIGITAL_PINS
+  static_assert(Pin < NUM_DIGITAL_PINS, "SCtransmitterT: invalid pin");
+#endif
+  
+  public:
+    typedef Profile profile;
+    static constexpr uint8_t pin = Pin;
+    
+    SCtransmitterT(void) : SCtransmitter(Pin){
+      SetTimes(Profile::duration_high, Profile::duration_low, Profile::start_duration_high, Profile::start_duration_low);
+    }
+};
+
+//---------------
+
+template <uint8_t Pin, uint8_t Id, class Profile = SCdefaultProfile>
+class SCreceiverT : public SCreceiver {
+#ifdef NUM_DIGITAL_PINS
+  static_assert(Pin < NUM_DIGITAL_PINS, "SCreceiverT: invalid pin");
+#endif
+  static_assert((Id >= 1) && (Id <= 15), "SCreceiverT: the ID must be in [1 - 15]");
+  
+  public:
+    typedef Profile profile;
+    static constexpr uint8_t pin = Pin;
+    static constexpr uint8_t id = Id;
+    
+    SCreceiverT(void) : SCreceiver(Pin, Id){
+      SetTimes(Profile::duration_high, Profile::duration_low, Profile::start_duration_high, Profile::start_duration_low);
+    }
+};
+
+#endif //C++11
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+const uint8_t SC_MAX_RECEIVERS = 10;
 uint8_t AddReceiver(SCreceiver *receiver);
 uint8_t RemoveReceiver(SCreceiver *receiver);
+uint8_t AddReceiverPort(volatile uint8_t *port);
+void RemoveReceiverPort(uint8_t index);
+uint8_t AddActiveReceiver(SCreceiver *receiver);
+uint8_t RemoveActiveReceiver(SCreceiver *receiver);
 
 const uint8_t SC_MAX_TRANSMITTERS = 5;
 uint8_t AddTransmitter(SCtransmitter *transmitter);
 uint8_t RemoveTransmitter(SCtransmitter *transmitter);
+uint8_t AddTransmitterPort(volatile uint8_t *port);
+void RemoveTransmitterPort(uint8_t index);
+uint8_t AddActiveTransmitter(SCtransmitter *transmitter);
+uint8_t RemoveActiveTransmitter(SCtransmitter *transmitter);
 
 
 uint8_t SC_CheckSum(uint8_t *message, uint8_t length);
+uint16_t SC_Check_Update(uint8_t type, uint16_t check, uint8_t data);
+uint8_t SC_CRC8(uint8_t crc, uint8_t data);
+uint16_t SC_CRC16(uint16_t crc, uint8_t data);
+uint8_t SC_FEC_Decode(uint16_t coded, uint8_t *corrected);
+uint16_t SC_FEC_Encode(uint8_t data);
+uint8_t SC_Dispatch(void);
+uint16_t SC_Get_Ticks(void);
+uint16_t SC_Get_Timestamp(void);
 void SC_Start_Timer(void);
 void SC_Stop_Timer(void);
+void SC_Timer_Tick(void); //DO NOT call from outside the library (is public for benchmarking)
+
+#if SC_USE_ICP || SC_USE_OC
+void SC_Start_Timer1(void);
+#endif
 
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,64 @@
+
+/*
+
+	RoboCore SimpleCom Auto Baud Example
+		(17/10/2026)
+
+  This example receives the messages of a
+  transmitter with other times, as the ones
+  of a board with a slower or faster clock.
+  The receiver keeps the default times and
+  learns the timing of the transmitter from
+  the START of each frame (see SetAutoBaud()).
+  All the times of the transmitter must have
+  the same ratio to the ones of the receiver.
+  Connect pin 4 (transmitter) to pin 5
+  (receiver) and send 't' through the serial.
+
+*/
+
+
+#include "SimpleCom.h"
+
+  SCreceiver Rcvr(5,1);
+  SCtransmitter Trmtr(4);
+
+byte received_message[SC_MESSAGE_SIZE];
+
+
+void setup(){
+  Serial.begin(9600);
+
+  //default times (4000, 2000) & (700, 400) at 80%
+  Trmtr.SetStart(3200, 1600);
+  Trmtr.SetInterval(560, 320);
+  Trmtr.SetID(1);
+
+  Rcvr.SetAutoBaud(1);
+  Rcvr.Listen();
+
+  Serial.println("--- start ---");
+}
+
+
+void loop(){
+  if(Serial.available() && (Serial.read() == 't')){
+    byte message[] = {0,1,6,0,1};
+    Trmtr.Send(message, 5);
+    Serial.println("\tdone! ");
+  }
+
+  if(Rcvr.GetMessage(received_message)){
+    Serial.print(Rcvr.GetMessageLength());
+    Serial.print(" - { ");
+    for(byte i=0 ; i < Rcvr.GetMessageLength() ; i++){
+      Serial.print(received_message[i]);
+      Serial.print(' ');
+    }
+    Serial.print("} at ");
+    Serial.print(Rcvr.GetTiming());
+    Serial.println("% of the times");
+    Rcvr.ClearBuffer();
+  }
+}
+
@@ -0,0 +1,361 @@
+
+/*
+
+	RoboCore SimpleCom Benchmark
+		(17/10/2026)
+
+  This example measures the cost of the timer
+  interrupt of the library, in CPU cycles per
+  tick. Timer 1 (16 bit) is used without
+  prescaler as a cycle counter, and the ticks
+  are called manually (the timer of the library
+  is stopped during the measurements).
+  Use the same connections of the Demo example,
+  so the receivers see the transitions of the
+  transmitters.
+  To compare the direct port access with the
+  digitalWrite()/digitalRead() path, set
+  SC_FAST_IO to 0 in SimpleCom.h and upload
+  the example again.
+  The CPU load is measured by counting the
+  iterations of an empty loop while the timer
+  of the library is running, for the timer and
+  for the pin change engines of the receivers
+  (set SC_USE_PCINT to 1 in SimpleCom.h to
+  enable the latter).
+  The checks of the frame are measured in
+  CPU cycles per byte (see SetCheck()), as
+  the encoding & decoding of the correction
+  (see SetCorrection()).
+  The goodput (bytes of the messages per
+  second) is measured from Trmtr2 to Rcvr,
+  with one START for each frame and with
+  bursts of frames (see SetBurst()), then
+  with each line code at the same shortest
+  pulse (see SetCode()), sending hundreds
+  of frames for each code, so the frames
+  lost give the error rate of the code. The last
+  measurement sends the same frames with the
+  correction, which doubles the bits of the
+  frame.
+  
+*/
+
+
+#include "SimpleCom.h"
+
+  SCreceiver Rcvr(5,1);
+  SCreceiver Rcvr2(7,2);
+  SCreceiver Rcvr3(11,3);
+  SCreceiver Rcvr4(12,4);
+  SCreceiver Rcvr5(13,5);
+  
+  SCtransmitter Trmtr(4);
+  SCtransmitter Trmtr2(6);
+  SCtransmitter Trmtr3(8);
+  SCtransmitter Trmtr4(9);
+  SCtransmitter Trmtr5(10);
+
+SCreceiver *receivers[] = { &Rcvr, &Rcvr2, &Rcvr3, &Rcvr4, &Rcvr5 };
+SCtransmitter *transmitters[] = { &Trmtr, &Trmtr2, &Trmtr3, &Trmtr4, &Trmtr5 };
+
+#define TICKS 1000 //number of ticks for each measurement
+#define LOAD_WINDOW 3125 //window of the CPU load measurement in Timer 1 counts (200 ms with prescaler of 1024)
+
+byte message[SC_MESSAGE_SIZE];
+volatile uint16_t check_result; //so the checks are not optimized out
+
+#define GOODPUT_FRAMES 4 //number of frames of each goodput measurement
+#define GOODPUT_LENGTH 4 //length of the messages of the goodput measurement
+#define CODE_FRAMES 200 //number of frames of each line code (to give the error rate)
+#define CODE_WAIT 1000 //ticks to wait for the last frame of each line code (100 ms)
+SCframe frames[GOODPUT_FRAMES + 1];
+SCmessage received[GOODPUT_FRAMES + 1];
+
+
+// Measure the average cycles of a tick
+uint32_t MeasureTick(void){
+  uint32_t total = 0;
+  uint16_t start;
+  
+  for(uint16_t i=0 ; i < TICKS ; i++){
+    cli();
+    start = TCNT1;
+    SC_Timer_Tick();
+    total += (uint16_t)(TCNT1 - start);
+    sei();
+  }
+  
+  return (total / TICKS);
+}
+
+
+// Count the iterations of an empty loop during the window
+//  (the interrupts of the library steal time from the loop)
+uint32_t CountLoop(void){
+  uint32_t count = 0;
+  
+  Serial.flush(); //wait for the serial transmission
+  TCCR1B = 0x05; //prescaler of 1024
+  TCNT1 = 0;
+  while(TCNT1 < LOAD_WINDOW)
+    count++;
+  TCCR1B = 0x01; //back to cycle counter
+  
+  return count;
+}
+
+
+void PrintLoad(const char *name, uint32_t count, uint32_t reference){
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(100 - (count * 100 / reference));
+  Serial.println("% CPU");
+}
+
+
+// Measure the CPU load of the receivers with the given engine
+void MeasureLoad(uint8_t engine, uint32_t reference){
+  for(uint8_t i=0 ; i < 5 ; i++){
+    receivers[i]->SetEngine(engine);
+    receivers[i]->Listen();
+  }
+  PrintLoad("  idle line", CountLoop(), reference);
+  
+  for(uint8_t i=0 ; i < 5 ; i++)
+    transmitters[i]->Send(message, SC_MESSAGE_SIZE);
+  PrintLoad("  busy line", CountLoop(), reference);
+  
+  for(uint8_t i=0 ; i < 5 ; i++){
+    transmitters[i]->Stop();
+    receivers[i]->Stop();
+  }
+}
+
+
+void PrintResult(const char *name, uint32_t cycles){
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(cycles);
+  Serial.println(" cycles/tick");
+}
+
+
+// Measure the average cycles of a check for each byte of the message
+void MeasureCheck(const char *name, uint8_t type){
+  uint16_t check = SC_CHECK_INIT(type);
+  uint16_t start;
+  uint16_t cycles;
+  
+  cli();
+  start = TCNT1;
+  for(uint8_t i=0 ; i < SC_MESSAGE_SIZE ; i++)
+    check = SC_Check_Update(type, check, message[i]);
+  cycles = TCNT1 - start;
+  sei();
+  check_result = check;
+  
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(cycles / SC_MESSAGE_SIZE);
+  Serial.println(" cycles/byte");
+}
+
+
+// Measure the average cycles to encode & to decode each byte with the correction
+//  (the decoding is called in the interrupt for the last bit of each byte)
+void MeasureCorrection(void){
+  uint16_t coded[SC_MESSAGE_SIZE];
+  uint8_t corrected = 0;
+  uint8_t value = 0;
+  uint16_t start;
+  uint16_t encode_cycles;
+  uint16_t decode_cycles;
+  
+  cli();
+  start = TCNT1;
+  for(uint8_t i=0 ; i < SC_MESSAGE_SIZE ; i++)
+    coded[i] = SC_FEC_Encode(message[i]);
+  encode_cycles = TCNT1 - start;
+  coded[1] ^= 0x0003; //2 bits in a row
+  start = TCNT1;
+  for(uint8_t i=0 ; i < SC_MESSAGE_SIZE ; i++)
+    value ^= SC_FEC_Decode(coded[i], &corrected);
+  decode_cycles = TCNT1 - start;
+  sei();
+  check_result = value;
+  
+  Serial.print("Hamming: ");
+  Serial.print(encode_cycles / SC_MESSAGE_SIZE);
+  Serial.print(" cycles/byte to encode, ");
+  Serial.print(decode_cycles / SC_MESSAGE_SIZE);
+  Serial.print(" cycles/byte to decode (");
+  Serial.print(corrected);
+  Serial.println(" bits corrected)");
+}
+
+
+// Measure the goodput from Trmtr2 to Rcvr with the given number of frames for each START
+void MeasureGoodput(const char *name, uint8_t burst){
+  Rcvr.SetQueue(received, GOODPUT_FRAMES + 1);
+  Rcvr.Listen();
+  Trmtr2.SetQueue(frames, GOODPUT_FRAMES + 1);
+  Trmtr2.SetBurst(burst);
+  Trmtr2.SetID(1);
+  
+  TCCR1B = 0x05; //prescaler of 1024 (64 us)
+  TCNT1 = 0;
+  for(uint8_t i=0 ; i < GOODPUT_FRAMES ; i++)
+    Trmtr2.Send(message, GOODPUT_LENGTH);
+  while((Rcvr.GetQueued() < GOODPUT_FRAMES) && (TCNT1 < 60000))
+    ; //wait for all the messages (or ~4 s)
+  uint32_t elapsed = (uint32_t)TCNT1 * 64; //in [us]
+  TCCR1B = 0x01; //back to cycle counter
+  
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(Rcvr.GetQueued());
+  Serial.print("/");
+  Serial.print(GOODPUT_FRAMES);
+  Serial.print(" frames, ");
+  Serial.print((uint32_t)Rcvr.GetQueued() * GOODPUT_LENGTH * 1000000UL / elapsed);
+  Serial.println(" bytes/s");
+  
+  Rcvr.SetQueue(NULL, 0);
+  Trmtr2.SetQueue(NULL, 0);
+  Trmtr2.SetBurst(1);
+}
+
+
+// Measure the goodput & the lost frames from Trmtr2 to Rcvr with the given line code
+//  (the shortest pulse is 200 us for all the codes)
+//  NOTE: the frames are sent again as the queue of Trmtr2 frees, and the
+//        time is counted in ticks of the library (see SC_Get_Ticks())
+void MeasureCode(const char *name, uint8_t code){
+  byte buffer[SC_MESSAGE_SIZE];
+  uint16_t sent = 0;
+  uint16_t valid = 0;
+  uint16_t last_tick;
+  uint16_t now;
+  uint32_t elapsed = 0; //in ticks
+  uint16_t wait = 0; //ticks after the last frame
+  
+  Trmtr2.SetCode(code);
+  Rcvr.SetCode(code);
+  Trmtr2.SetInterval(400, 200);
+  Rcvr.SetInterval(400, 200);
+  Rcvr.SetQueue(received, GOODPUT_FRAMES + 1);
+  Rcvr.Listen();
+  Trmtr2.SetQueue(frames, GOODPUT_FRAMES + 1);
+  Trmtr2.SetID(1);
+  
+  last_tick = SC_Get_Ticks();
+  while(wait < CODE_WAIT){
+    if((sent < CODE_FRAMES) && (Trmtr2.Send(message, GOODPUT_LENGTH) == 1))
+      sent++;
+    while(Rcvr.PopMessage(buffer) == 1){
+      if(memcmp(buffer, message, GOODPUT_LENGTH) == 0)
+        valid++;
+    }
+    
+    now = SC_Get_Ticks();
+    if((sent < CODE_FRAMES) || Trmtr2.isSending())
+      elapsed += (uint16_t)(now - last_tick);
+    else
+      wait += (uint16_t)(now - last_tick); //for the last frame to be received
+    last_tick = now;
+  }
+  
+  Serial.print(name);
+  Serial.print(": ");
+  Serial.print(valid);
+  Serial.print("/");
+  Serial.print(sent);
+  Serial.print(" frames (");
+  Serial.print(sent - valid);
+  Serial.print(" lost), ");
+  Serial.print((uint32_t)valid * GOODPUT_LENGTH * (1000000UL / SC_TIMER_INTERVAL) / elapsed);
+  Serial.println(" bytes/s");
+  
+  Rcvr.SetQueue(NULL, 0);
+  Trmtr2.SetQueue(NULL, 0);
+  Trmtr2.SetCode(SC_CODE_PWM);
+  Rcvr.SetCode(SC_CODE_PWM);
+  Trmtr2.SetInterval(SC_DEFAULT_DURATION_HIGH, SC_DEFAULT_DURATION_LOW);
+  Rcvr.SetInterval(SC_DEFAULT_DURATION_HIGH, SC_DEFAULT_DURATION_LOW);
+}
+
+
+void setup(){
+  Serial.begin(9600);
+  
+  for(uint8_t i=0 ; i < SC_MESSAGE_SIZE ; i++)
+    message[i] = i * 17; //mix of ONEs and ZEROs
+  
+  //Timer 1 as cycle counter
+  TCCR1A = 0x00;
+  TCCR1B = 0x01; //no prescaler
+  TIMSK1 = 0x00;
+  
+  Serial.print("SC_FAST_IO: ");
+  Serial.println(SC_FAST_IO);
+  
+  SC_Stop_Timer();
+  PrintResult("Idle", MeasureTick());
+  
+  for(uint8_t i=0 ; i < 5 ; i++)
+    receivers[i]->Listen();
+  SC_Stop_Timer(); //Listen() starts the timer
+  PrintResult("5 receivers (idle line)", MeasureTick());
+  
+  for(uint8_t i=0 ; i < 5 ; i++){
+    transmitters[i]->SetID(i + 1);
+    transmitters[i]->Send(message, SC_MESSAGE_SIZE);
+  }
+  SC_Stop_Timer(); //Send() starts the timer
+  PrintResult("5 transmitters + 5 receivers", MeasureTick());
+  
+  for(uint8_t i=0 ; i < 5 ; i++)
+    receivers[i]->Stop();
+  for(uint8_t i=0 ; i < 5 ; i++)
+    transmitters[i]->Send(message, SC_MESSAGE_SIZE);
+  SC_Stop_Timer();
+  PrintResult("5 transmitters", MeasureTick());
+  
+  //checks of the frame
+  MeasureCheck("Sum", SC_CHECK_SUM);
+  MeasureCheck("CRC-8", SC_CHECK_CRC8);
+  MeasureCheck("CRC-16", SC_CHECK_CRC16);
+  MeasureCorrection();
+  
+  //CPU load
+  uint32_t reference = CountLoop(); //timer stopped
+  SC_Start_Timer();
+  Serial.println("Timer engine");
+  MeasureLoad(SC_ENGINE_TIMER, reference);
+#if SC_USE_PCINT
+  Serial.println("Pin change engine");
+  MeasureLoad(SC_ENGINE_PCINT, reference);
+#endif
+  
+  //goodput
+  MeasureGoodput("1 START per frame", 1);
+  MeasureGoodput("1 START per burst", GOODPUT_FRAMES);
+  MeasureCode("PWM", SC_CODE_PWM);
+  MeasureCode("PWM4", SC_CODE_PWM4);
+  MeasureCode("Manchester", SC_CODE_MANCHESTER);
+  Trmtr2.SetCorrection(SC_FEC_HAMMING);
+  Rcvr.SetCorrection(SC_FEC_HAMMING);
+  MeasureGoodput("1 START per frame + Hamming", 1);
+  Serial.print("  bits corrected: ");
+  Serial.println(Rcvr.GetCorrectedBits());
+  Trmtr2.SetCorrection(SC_FEC_NONE);
+  Rcvr.SetCorrection(SC_FEC_NONE);
+  
+  Serial.println("--- done ---");
+}
+
+
+void loop(){
+}
+
@@ -55,8 +55,8 @@ void setup(){
   Serial.print(',');
   Serial.println(Rcvr5.Listen());
   
-  Serial.print("OCR0A: ");
-  Serial.println(T_OCR0A);
+  Serial.print("OCRxA: ");
+  Serial.println(T_OCR);
   Serial.print("Prescaler: ");
   Serial.println(T_PRESCALER);
   Serial.print("Interval: ");
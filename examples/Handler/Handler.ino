@@ -0,0 +1,70 @@
+
+/*
+
+	RoboCore SimpleCom Handler Example
+		(17/10/2026)
+
+  This example receives the messages with a
+  handler instead of polling the receivers.
+  The transmitter queues 3 messages that are
+  sent back to back, the receiver keeps them
+  in its queue and SC_Dispatch() calls the
+  handler for each one, in place (no copy).
+  Connect pin 4 (transmitter) to pin 5
+  (receiver) and send 't' through the serial.
+
+*/
+
+
+#include "SimpleCom.h"
+
+  SCreceiver Rcvr(5,1);
+  SCtransmitter Trmtr(4);
+
+SCmessage received[4]; //holds 3 messages
+SCframe frames[4]; //holds 3 frames
+
+
+// Print the message with the pin of the receiver (called by SC_Dispatch())
+void PrintMessage(SCreceiver *receiver, const uint8_t *message, uint8_t length){
+  Serial.print("pin ");
+  Serial.print(receiver->GetPin());
+  Serial.print(": ");
+  Serial.print(length);
+  Serial.print(" - { ");
+  for(uint8_t i=0 ; i < length ; i++){
+    Serial.print(message[i]);
+    if(i < (length - 1))
+      Serial.print(", ");
+  }
+  Serial.println(" }");
+}
+
+
+void setup(){
+  Serial.begin(9600);
+
+  Rcvr.SetQueue(received, 4);
+  Rcvr.SetHandler(PrintMessage);
+  Rcvr.Listen();
+
+  Trmtr.SetQueue(frames, 4);
+  Trmtr.SetID(1);
+
+  Serial.println("--- start ---");
+}
+
+
+void loop(){
+  if(Serial.available() && (Serial.read() == 't')){
+    byte message[] = {0,1,6,0,1};
+    for(byte i=1 ; i <= 3 ; i++){
+      message[0] = i;
+      Serial.print(Trmtr.Send(message, 5)); //1 if queued, 0 if full
+    }
+    Serial.println("\tdone! ");
+  }
+
+  SC_Dispatch(); //call the handler for each message received
+}
+
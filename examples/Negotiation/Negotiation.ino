@@ -0,0 +1,77 @@
+
+/*
+
+	RoboCore SimpleCom Negotiation Example
+		(17/10/2026)
+
+  This example negotiates the fastest times
+  of a link with test frames. Both sides are
+  in the same Arduino: Trmtr sends to Rcvr2
+  (the link negotiated) and Trmtr2 sends the
+  answers back to Rcvr (with its own times).
+  Connect pin 4 to pin 5 and pin 6 to pin 7,
+  and send 'n' through the serial. The times
+  of each step are printed with the frame
+  error rate and the goodput, so the choice
+  can be checked. The selected times can be
+  stored (ex: in the EEPROM) and set with
+  SetInterval() to skip the negotiation.
+
+*/
+
+
+#include "SimpleCom.h"
+
+  SCtransmitter Trmtr(4);
+  SCreceiver Rcvr2(5,2);
+  SCtransmitter Trmtr2(6);
+  SCreceiver Rcvr(7,1);
+
+SCnegotiator Link(&Trmtr, &Rcvr); //this side
+SCnegotiator Other(&Trmtr2, &Rcvr2); //the other side (answers)
+
+#define TARGET 10 //maximum frame error rate in [%]
+
+
+void setup(){
+  Serial.begin(9600);
+
+  Trmtr.SetID(2);
+  Trmtr2.SetID(1);
+  Rcvr.Listen();
+  Rcvr2.Listen();
+
+  Serial.println("--- start ---");
+}
+
+
+void loop(){
+  if(Serial.available() && (Serial.read() == 'n')){
+    Link.Start(TARGET);
+    Serial.println("negotiating...");
+  }
+
+  //both sides must be updated
+  uint8_t negotiating = Link.isNegotiating();
+  Link.Update();
+  Other.Update();
+
+  //print the steps at the end of the negotiation
+  if(negotiating && !Link.isNegotiating()){
+    for(byte i=0 ; i < Link.GetSteps() ; i++){
+      Serial.print(Link.GetDurationHIGH(i));
+      Serial.print('/');
+      Serial.print(Link.GetDurationLOW(i));
+      Serial.print(" us: ");
+      Serial.print(Link.GetErrorRate(i));
+      Serial.print("% errors, ");
+      Serial.print(Link.GetGoodput(i));
+      Serial.println(" bytes/s");
+    }
+    Serial.print("selected: ");
+    Serial.print(Trmtr.GetDurationHIGH());
+    Serial.print('/');
+    Serial.println(Trmtr.GetDurationLOW());
+  }
+}
+